@@ -0,0 +1,347 @@
+/*-- BatchDriver.cpp ---------------------------------------------------------
+              This file implements BatchDriver member functions.
+--------------------------------------------------------------------------*/
+
+#include "BatchDriver.h"
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+// Returns the latency at quantile q (0..1) of sorted latencies
+static long long percentile(const vector<long long>& sorted, double q){
+    if(sorted.empty())
+        return 0;
+
+    size_t index = (size_t)(q * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+// Removes leading and trailing spaces
+static string trim(const string& text){
+    size_t first = text.find_first_not_of(" \t\r");
+    if(first == string::npos)
+        return "";
+
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+//--- Definition of BatchDriver constructor
+BatchDriver::BatchDriver(Menu& menu, OrderQueue& orders,
+                         CompletedOrderStack& completed, KitchenExecutor& kitchen,
+                         int& itemId, int& orderId, OrderLog* log,
+                         const BestSellers* sellers)
+    : menu(menu), orders(orders), completed(completed), kitchen(kitchen),
+      itemId(itemId), orderId(orderId), log(log), sellers(sellers), wallSeconds(0) {
+}
+
+//--- Definition of run()
+int BatchDriver::run(istream& in){
+    TRACE_SPAN("BatchDriver::run");
+    chrono::steady_clock::time_point runStart = chrono::steady_clock::now();
+    int failures = 0;
+    int lineNumber = 0;
+    string line;
+
+    while(getline(in, line)){
+        lineNumber++;
+
+        string text = trim(line);
+        if(text.empty() || text[0] == '#')
+            continue;
+
+        // Split the command word from its arguments
+        size_t space = text.find(' ');
+        string command = text.substr(0, space);
+        string arguments = space == string::npos ? "" : trim(text.substr(space));
+
+        string error;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        bool ok = execute(command, arguments, error);
+        long long nanoseconds = chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - start).count();
+
+        CommandStats& entry = stats[command];
+        entry.latencies.push_back(nanoseconds);
+        if(!ok){
+            entry.failures++;
+            failures++;
+            cerr << "Line " << lineNumber << ": " << error << endl;
+        }
+    }
+
+    wallSeconds += chrono::duration<double>(
+        chrono::steady_clock::now() - runStart).count();
+    return failures;
+}
+
+//--- Definition of execute()
+bool BatchDriver::execute(const string& command, const string& arguments,
+                          string& error){
+    if(command == "add"){
+        // Same layout as a menu.txt line, without the ID
+        stringstream ss(arguments);
+        string name, description, priceText;
+        getline(ss, name, ',');
+        getline(ss, description, ',');
+        getline(ss, priceText);
+
+        Money price;
+        if(name.empty() || description.empty()
+            || !Money::parse(priceText, price) || price <= Money()){
+            error = "add expects <name>,<description>,<price>";
+            return false;
+        }
+
+        MenuItem item(itemId++, name, description, price);
+        menu.addItem(item);
+        if(log)
+            log->logMenuAdd(item);
+        return true;
+    }
+
+    if(command == "delete"){
+        int id = atoi(arguments.c_str());
+        if(!menu.deleteItem(id)){
+            error = "item " + arguments + " not found";
+            return false;
+        }
+        if(log)
+            log->logMenuDelete(id);
+        return true;
+    }
+
+    if(command == "reset"){
+        menu.reset();
+        if(log)
+            log->logMenuReset();
+        return true;
+    }
+
+    if(command == "order"){
+        size_t colon = arguments.find(':');
+        if(colon == string::npos || trim(arguments.substr(0, colon)).empty()){
+            error = "order expects <customer>: <item id> ...";
+            return false;
+        }
+
+        Order order(orderId, trim(arguments.substr(0, colon)), &menu);
+        order.stamp(Order::CREATED);
+        stringstream ids(arguments.substr(colon + 1));
+        vector<int> itemIds;
+        int id;
+        while(ids >> id){
+            itemIds.push_back(id);
+        }
+
+        // Only the prices are needed, looked up together
+        vector<Money> prices;
+        menu.getPrices(itemIds, prices);
+        string missing;
+        for(size_t i = 0; i < itemIds.size(); i++){
+            if(prices[i] != Money()){ // Items not on the menu have no price
+                order.addLine(itemIds[i], 1, prices[i]);
+            } else {
+                missing += " " + to_string(itemIds[i]);
+            }
+        }
+
+        bool created = !order.isEmpty();
+        if(created){
+            if(log)
+                log->logOrderAdd(order);
+            orders.enqueue(move(order));
+            orderId++;
+        }
+
+        if(!missing.empty()){
+            error = "item(s) not found:" + missing
+                + (created ? "" : ", order not created");
+            return false;
+        }
+        if(!created){
+            error = "order has no items";
+            return false;
+        }
+        return true;
+    }
+
+    if(command == "process"){
+        kitchen.drain(orders, completed);
+        return true;
+    }
+
+    if(command == "cancel"){
+        int id = atoi(arguments.c_str());
+        if(!orders.deleteOrder(id)){
+            error = "order " + arguments + " not found";
+            return false;
+        }
+        if(log)
+            log->logOrderDelete(id);
+        return true;
+    }
+
+    if(command == "revenue"){
+        // Same work as the interactive report, without the printing
+        Money total;
+        CompletedOrderStack::const_reverse_iterator it;
+        for(it = completed.rbegin(); it != completed.rend(); ++it){
+            total += it->calculateTotalAmount();
+        }
+
+        if(total != completed.calculateTotalRevenue()){
+            error = "revenue " + total.toString() + " does not match running total "
+                + completed.calculateTotalRevenue().toString();
+            return false;
+        }
+        return true;
+    }
+
+    if(command == "analytics"){
+        // Column store reports must agree with the stack to the cent
+        OrderAnalytics analytics;
+        analytics.loadFrom(completed);
+
+        Money byItem;
+        vector<OrderAnalytics::ItemSales> sales = analytics.salesByItem();
+        for(size_t i = 0; i < sales.size(); i++){
+            byItem += sales[i].revenue;
+        }
+
+        Money expected = completed.calculateTotalRevenue();
+        if(analytics.calculateTotalRevenue() != expected || byItem != expected){
+            error = "analytics revenue " + analytics.calculateTotalRevenue().toString()
+                + " (by item " + byItem.toString() + ") does not match "
+                + expected.toString();
+            return false;
+        }
+        return true;
+    }
+
+    if(command == "top"){
+        int count = arguments.empty() ? 10 : atoi(arguments.c_str());
+        if(!sellers || count <= 0){
+            error = sellers ? "top expects a positive count" : "best sellers are not tracked";
+            return false;
+        }
+        vector<BestSellers::Entry> best = sellers->top(count, time(0));
+
+        // Each estimate must bound the exact quantity from both sides
+        OrderAnalytics analytics;
+        analytics.loadFrom(completed);
+        vector<OrderAnalytics::ItemSales> sales = analytics.salesByItem();
+        map<int, long long> exact;
+        for(size_t i = 0; i < sales.size(); i++){
+            exact[sales[i].itemId] = sales[i].quantity;
+        }
+
+        for(size_t i = 0; i < best.size(); i++){
+            long long sold = exact[best[i].itemId];
+            if(sold > best[i].quantity || sold < best[i].quantity - best[i].error){
+                error = "item " + to_string(best[i].itemId) + " sold " + to_string(sold)
+                    + ", outside the estimate " + to_string(best[i].quantity)
+                    + " - " + to_string(best[i].error);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    if(command == "search"){
+        if(arguments.empty()){
+            error = "search expects text";
+            return false;
+        }
+        vector<MenuItem> found = menu.search(arguments);
+
+        // Every query word must start a word of each item found
+        vector<string> queryWords, itemWords, descriptionWords;
+        MenuSearch::tokenize(arguments, queryWords);
+        for(size_t i = 0; i < found.size(); i++){
+            MenuSearch::tokenize(found[i].getName(), itemWords);
+            MenuSearch::tokenize(found[i].getDescription(), descriptionWords);
+            itemWords.insert(itemWords.end(), descriptionWords.begin(), descriptionWords.end());
+
+            for(size_t q = 0; q < queryWords.size(); q++){
+                bool matched = false;
+                for(size_t w = 0; w < itemWords.size() && !matched; w++){
+                    matched = itemWords[w].compare(0, queryWords[q].size(), queryWords[q]) == 0;
+                }
+                if(!matched){
+                    error = "item " + to_string(found[i].getId()) + " does not match \""
+                        + queryWords[q] + "\"";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    if(command == "save"){
+        string filename = arguments.empty()
+            ? CompletedOrderStack::dailyFileName(time(0)) : arguments;
+        vector<int> savedIds;
+        int saved = completed.appendToFile(filename, &savedIds);
+        if(saved < 0){
+            error = "could not save " + filename;
+            return false;
+        }
+        if(saved > 0 && log){
+            log->logOrdersSaved(savedIds);
+            log->flush(); // The file already holds them
+        }
+        return true;
+    }
+
+    error = "unknown command \"" + command + "\"";
+    return false;
+}
+
+//--- Definition of printReport()
+void BatchDriver::printReport(ostream& out) const {
+    long long commands = 0;
+    map<string, CommandStats>::const_iterator it;
+    for(it = stats.begin(); it != stats.end(); ++it){
+        commands += it->second.latencies.size();
+    }
+
+    out << "--- Batch Report ---" << endl;
+    out << "Wall-clock time: " << fixed << setprecision(3)
+        << wallSeconds * 1000 << " ms" << endl;
+    out << "Commands: " << commands;
+    if(wallSeconds > 0)
+        out << " (" << setprecision(0) << commands / wallSeconds << " per second)";
+    out << endl;
+    out.unsetf(ios::fixed);
+    out << setprecision(6);
+
+    out << "Pending orders: " << (orders.isEmpty() ? "none" : "some")
+        << ", completed orders: " << completed.size()
+        << ", revenue: $" << completed.calculateTotalRevenue() << endl;
+
+    out << left << setw(10) << "Command" << right << setw(10) << "Count"
+        << setw(10) << "Failed" << setw(12) << "p50 (us)" << setw(12) << "p90 (us)"
+        << setw(12) << "p99 (us)" << setw(12) << "max (us)" << endl;
+
+    for(it = stats.begin(); it != stats.end(); ++it){
+        vector<long long> sorted = it->second.latencies;
+        sort(sorted.begin(), sorted.end());
+
+        out << left << setw(10) << it->first << right
+            << setw(10) << sorted.size() << setw(10) << it->second.failures
+            << fixed << setprecision(2)
+            << setw(12) << percentile(sorted, 0.50) / 1000.0
+            << setw(12) << percentile(sorted, 0.90) / 1000.0
+            << setw(12) << percentile(sorted, 0.99) / 1000.0
+            << setw(12) << (sorted.empty() ? 0 : sorted.back()) / 1000.0 << endl;
+        out.unsetf(ios::fixed);
+        out << setprecision(6);
+    }
+
+    if(kitchen.getTimeToComplete().getCount() > 0)
+        kitchen.printLatency(out);
+}
@@ -0,0 +1,126 @@
+/*-- BatchDriver.h -----------------------------------------------------------
+
+  This header file defines the BatchDriver class, which runs a scripted
+  stream of commands against the Menu, OrderQueue and CompletedOrderStack
+  without any prompts. It is used to replay recorded traffic and to measure
+  throughput: every command is timed, and a report of wall-clock time,
+  operation counts and latency percentiles is printed at the end.
+
+  Command format (one command per line; blank lines and lines starting
+  with '#' are ignored):
+    add <name>,<description>,<price>    Add a menu item with the next item ID.
+    delete <item id>                    Delete a menu item.
+    reset                               Remove every menu item.
+    order <customer>: <item id> ...     Queue a new order with the next order ID.
+    process                             Send every pending order through the kitchen.
+    cancel <order id>                   Delete a pending order.
+    revenue                             Compute every order total and the revenue.
+    analytics                           Build the sales column store and check
+                                        its revenue against the stack.
+    top [count]                         Read the best sellers (default 10) and
+                                        check their bounds against exact counts.
+    search <text>                       Search the menu and check that every
+                                        item found matches the text.
+    save [file name]                    Append the newly completed orders (default:
+                                        the dated file used by the menu).
+
+  Basic operations:
+    Constructor:       Binds the driver to the system it drives.
+    run:               Executes every command of an input stream.
+    printReport:       Outputs timing and latency statistics.
+
+  Class Invariant:
+    1. `stats` holds one entry per command name run so far, with the
+       latency of every execution in nanoseconds.
+    2. itemId and orderId are the next IDs to assign, shared with main.
+-----------------------------------------------------------------------------*/
+
+#ifndef BATCHDRIVER_H
+#define BATCHDRIVER_H
+
+#include "Menu.h"
+#include "OrderQueue.h"
+#include "CompletedOrderStack.h"
+#include "KitchenExecutor.h"
+#include "OrderLog.h"
+#include "OrderAnalytics.h"
+#include "BestSellers.h"
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class BatchDriver {
+public:
+    /***** Constructor *****/
+    BatchDriver(Menu& menu, OrderQueue& orders, CompletedOrderStack& completed,
+                KitchenExecutor& kitchen, int& itemId, int& orderId,
+                OrderLog* log = NULL, const BestSellers* sellers = NULL);
+    /*------------------------------------------------------------------------
+      Construct a driver for the given system. If log is given, every change
+      is recorded in it like in interactive mode. sellers is the all-time
+      tracker that the kitchen feeds, read by the top command.
+
+      Precondition:  The referenced objects outlive the driver.
+      Postcondition: The driver is ready to run commands; no statistics yet.
+    ------------------------------------------------------------------------*/
+
+    /***** Batch Operations *****/
+    int run(istream& in);
+    /*------------------------------------------------------------------------
+      Execute every command read from in, as fast as possible.
+
+      Precondition:  in is open.
+      Postcondition: All commands have been executed and timed. Malformed
+                     or failing commands are reported on cerr with their
+                     line number and counted. Returns the number of
+                     commands that failed.
+    ------------------------------------------------------------------------*/
+
+    void printReport(ostream& out) const;
+    /*------------------------------------------------------------------------
+      Output the statistics of the commands run so far.
+
+      Precondition:  ostream out is open.
+      Postcondition: Outputs the wall-clock time, the number of commands,
+                     the final queue, stack and revenue figures, and for
+                     each command name its count, failures and p50, p90,
+                     p99 and maximum latency, then the order latency
+                     histograms of the kitchen.
+    ------------------------------------------------------------------------*/
+
+private:
+    /***** Per-Command Statistics *****/
+    struct CommandStats {
+        vector<long long> latencies;  // Nanoseconds, one per execution
+        int failures;                 // Executions that reported an error
+
+        CommandStats() : failures(0) {}
+    };
+
+    Menu& menu;
+    OrderQueue& orders;
+    CompletedOrderStack& completed;
+    KitchenExecutor& kitchen;
+    int& itemId;
+    int& orderId;
+    OrderLog* log;                    // NULL if changes are not logged
+    const BestSellers* sellers;       // NULL if best sellers are not tracked
+
+    map<string, CommandStats> stats;  // Statistics by command name
+    double wallSeconds;               // Total time spent in run()
+
+    bool execute(const string& command, const string& arguments, string& error);
+    /*------------------------------------------------------------------------
+      Execute one command.
+
+      Precondition:  command is the first word of a script line and
+                     arguments the rest of it.
+      Postcondition: Returns true if the command succeeded; otherwise
+                     returns false and describes the problem in error.
+    ------------------------------------------------------------------------*/
+};
+
+#endif // BATCHDRIVER_H
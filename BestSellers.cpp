@@ -0,0 +1,179 @@
+/*-- BestSellers.cpp ---------------------------------------------------------
+              This file implements BestSellers member functions.
+--------------------------------------------------------------------------*/
+
+#include "BestSellers.h"
+#include <algorithm>
+
+// Splits a time into local calendar fields without the shared buffer of
+// localtime(), as orders are recorded from several threads
+static tm localFields(time_t when){
+    tm fields;
+#if defined(_WIN32)
+    localtime_s(&fields, &when);
+#else
+    localtime_r(&when, &fields);
+#endif
+    return fields;
+}
+
+//--- Definition of BestSellers constructor
+BestSellers::BestSellers(int capacity, int windowSeconds)
+    : capacity(capacity > 0 ? capacity : 1), windowSeconds(windowSeconds),
+      total(0), windowStart(0), windowEnd(0) {
+    heap.reserve(this->capacity);
+    position.reserve(this->capacity);
+}
+
+//--- Definition of record()
+void BestSellers::record(const Order& order, time_t now){
+    lock_guard<mutex> guard(lock);
+
+    // Tumbling window: the first order after the window starts a new one
+    if (windowSeconds != ALL_TIME && now >= windowEnd) {
+        heap.clear();
+        position.clear();
+        total = 0;
+        windowStart = getWindowStart(now);
+        windowEnd = windowStart + windowSeconds;
+    }
+
+    for (int i = 0; i < order.getItemCount(); i++) {
+        const OrderLine& line = order.getLine(i);
+        if (line.quantity > 0) {
+            add(line.itemId, line.quantity);
+            total += line.quantity;
+        }
+    }
+}
+
+//--- Definition of add()
+void BestSellers::add(int itemId, long long quantity){
+    unordered_map<int, int>::iterator found = position.find(itemId);
+    if (found != position.end()) {
+        int index = found->second;
+        heap[index].quantity += quantity;
+        siftDown(index); // A larger count moves away from the root
+        return;
+    }
+
+    if ((int)heap.size() < capacity) {
+        Entry entry = { itemId, quantity, 0 };
+        heap.push_back(entry);
+        position[itemId] = (int)heap.size() - 1;
+        siftUp((int)heap.size() - 1);
+        return;
+    }
+
+    // Every counter is in use: the item takes over the smallest one, whose
+    // count may all have been the evicted item's
+    Entry& smallest = heap[0];
+    position.erase(smallest.itemId);
+    smallest.itemId = itemId;
+    smallest.error = smallest.quantity;
+    smallest.quantity += quantity;
+    position[itemId] = 0;
+    siftDown(0);
+}
+
+//--- Definition of siftDown()
+void BestSellers::siftDown(int index){
+    int size = (int)heap.size();
+    while (true) {
+        int smallest = index;
+        int left = 2 * index + 1;
+        int right = left + 1;
+        if (left < size && heap[left].quantity < heap[smallest].quantity)
+            smallest = left;
+        if (right < size && heap[right].quantity < heap[smallest].quantity)
+            smallest = right;
+        if (smallest == index)
+            return;
+
+        swapEntries(index, smallest);
+        index = smallest;
+    }
+}
+
+//--- Definition of siftUp()
+void BestSellers::siftUp(int index){
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (heap[parent].quantity <= heap[index].quantity)
+            return;
+
+        swapEntries(index, parent);
+        index = parent;
+    }
+}
+
+//--- Definition of swapEntries()
+void BestSellers::swapEntries(int a, int b){
+    swap(heap[a], heap[b]);
+    position[heap[a].itemId] = a;
+    position[heap[b].itemId] = b;
+}
+
+//--- Definition of top()
+vector<BestSellers::Entry> BestSellers::top(int k, time_t now) const {
+    lock_guard<mutex> guard(lock);
+
+    vector<Entry> best;
+    if (windowSeconds != ALL_TIME && now >= windowEnd)
+        return best; // Nothing sold in the window of now yet
+
+    // Only the k largest of the counters are sorted
+    best = heap;
+    size_t count = min((size_t)max(k, 0), best.size());
+    auto larger = [](const Entry& a, const Entry& b){
+        return a.quantity > b.quantity || (a.quantity == b.quantity && a.itemId < b.itemId);
+    };
+    if (count < best.size())
+        nth_element(best.begin(), best.begin() + count, best.end(), larger);
+    best.resize(count);
+    sort(best.begin(), best.end(), larger);
+    return best;
+}
+
+//--- Definition of reset()
+void BestSellers::reset(){
+    lock_guard<mutex> guard(lock);
+    heap.clear();
+    position.clear();
+    total = 0;
+    windowStart = windowEnd = 0;
+}
+
+//--- Definition of getCapacity()
+int BestSellers::getCapacity() const {
+    return capacity;
+}
+
+//--- Definition of getWindowSeconds()
+int BestSellers::getWindowSeconds() const {
+    return windowSeconds;
+}
+
+//--- Definition of getWindowStart()
+time_t BestSellers::getWindowStart(time_t now) const {
+    if (windowSeconds == ALL_TIME)
+        return 0;
+
+    // Windows are counted from local midnight, so hours and days follow
+    // the clock on the wall
+    tm midnight = localFields(now);
+    midnight.tm_hour = midnight.tm_min = midnight.tm_sec = 0;
+    midnight.tm_isdst = -1;
+    time_t dayStart = mktime(&midnight);
+
+    return dayStart + (now - dayStart) / windowSeconds * windowSeconds;
+}
+
+//--- Definition of getTotal()
+long long BestSellers::getTotal(time_t now) const {
+    lock_guard<mutex> guard(lock);
+
+    if (windowSeconds != ALL_TIME && now >= windowEnd)
+        return 0;
+    return total;
+}
@@ -0,0 +1,160 @@
+/*-- BestSellers.h -----------------------------------------------------------
+
+  This header file defines the BestSellers class, a streaming tracker of
+  the items sold in the largest quantities. It is updated once per
+  completed order and never rescans past orders or the menu.
+
+  It implements the Space-Saving algorithm, weighted by quantity: at most
+  `capacity` items are counted at once. An item that is already counted
+  has its count raised; a new item takes the counter of the item with the
+  smallest count, inheriting that count as its possible error. Every item
+  sold more than total / capacity units is guaranteed to be counted, and
+  each count overestimates the true quantity by at most its error. Memory
+  stays the same however large the menu is.
+
+  The counters form a min-heap on count, so the smallest one is found in
+  constant time and an update costs O(log capacity). A top-K query selects
+  from the `capacity` counters, which is O(K) for a capacity that is a
+  fixed multiple of K.
+
+  A tracker may count over a tumbling window instead of all time: with a
+  window of one hour, counting starts over at the top of every hour (local
+  time); with one day, at midnight.
+
+  Basic operations:
+    Constructor:       Creates a tracker with a capacity and a window.
+    record:            Counts the lines of a completed order.
+    top:               Returns the K best sellers of the current window.
+    reset:             Forgets every count.
+    Accessors:         Capacity, window length and start, units counted.
+
+  Class Invariant:
+    1. `heap` holds at most `capacity` counters, each count no smaller than
+       its parent's; `position` maps each counted item ID to its index.
+    2. `total` is the number of units recorded in the current window,
+       [windowStart, windowEnd); both are 0 until an order is recorded, and
+       stay 0 for an all-time tracker.
+    3. All members below the lock are guarded by `lock`, so orders can be
+       recorded from several kitchen workers at once.
+-----------------------------------------------------------------------------*/
+
+#ifndef BESTSELLERS_H
+#define BESTSELLERS_H
+
+#include "Order.h"
+#include <ctime>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+class BestSellers {
+public:
+    /***** Counter *****/
+    struct Entry {
+        int itemId;
+        long long quantity;  // Units counted, at least the units sold
+        long long error;     // quantity - error is at most the units sold
+    };
+
+    /***** Window Lengths *****/
+    static const int ALL_TIME = 0;
+    static const int HOUR = 3600;
+    static const int DAY = 86400;
+
+    /***** Constructor *****/
+    BestSellers(int capacity = 64, int windowSeconds = ALL_TIME);
+    /*------------------------------------------------------------------------
+      Construct an empty tracker.
+
+      Precondition:  capacity > 0; windowSeconds is ALL_TIME or divides a
+                     day (HOUR, DAY, 900, ...).
+      Postcondition: Up to capacity items are counted at once, over all
+                     time or over tumbling windows of windowSeconds.
+    ------------------------------------------------------------------------*/
+
+    /***** Tracking *****/
+    void record(const Order& order, time_t now);
+    /*------------------------------------------------------------------------
+      Count the items of a completed order.
+
+      Precondition:  now is the time the order was completed.
+      Postcondition: If now falls after the current window, counting starts
+                     over in the window of now. The quantity of each line
+                     is added to its item's counter. May be called from
+                     several threads.
+    ------------------------------------------------------------------------*/
+
+    vector<Entry> top(int k, time_t now) const;
+    /*------------------------------------------------------------------------
+      Retrieve the best sellers.
+
+      Precondition:  k > 0.
+      Postcondition: Returns up to k entries of the window that contains
+                     now, by decreasing quantity (empty if nothing was sold
+                     in it yet).
+    ------------------------------------------------------------------------*/
+
+    void reset();
+    /*------------------------------------------------------------------------
+      Forget every count.
+
+      Precondition:  None.
+      Postcondition: The tracker is as constructed.
+    ------------------------------------------------------------------------*/
+
+    /***** Accessors *****/
+    int getCapacity() const;
+    int getWindowSeconds() const;
+    time_t getWindowStart(time_t now) const;
+    /*------------------------------------------------------------------------
+      Retrieve the start of the window that contains now.
+
+      Precondition:  None.
+      Postcondition: Returns the local start of now's hour, day or other
+                     window, or 0 for an all-time tracker.
+    ------------------------------------------------------------------------*/
+
+    long long getTotal(time_t now) const;
+    /*------------------------------------------------------------------------
+      Retrieve the units counted in the window that contains now.
+
+      Precondition:  None.
+      Postcondition: Returns the units recorded in it; each count is off by
+                     at most getTotal() / getCapacity().
+    ------------------------------------------------------------------------*/
+
+private:
+    int capacity;
+    int windowSeconds;
+
+    mutable mutex lock;                   // Guards everything below
+    vector<Entry> heap;                   // Min-heap on quantity
+    unordered_map<int, int> position;     // Item ID -> index in heap
+    long long total;
+    time_t windowStart;                   // The current window is
+    time_t windowEnd;                     // [windowStart, windowEnd)
+
+    void add(int itemId, long long quantity);
+    /*------------------------------------------------------------------------
+      Count units of one item.
+
+      Precondition:  lock is held; quantity > 0.
+      Postcondition: The item's counter is raised, or the smallest counter
+                     is taken over if all are in use.
+    ------------------------------------------------------------------------*/
+
+    void siftDown(int index);
+    void siftUp(int index);
+    /*------------------------------------------------------------------------
+      Restore the heap after the count at index changed.
+
+      Precondition:  lock is held; the heap holds everywhere but at index.
+      Postcondition: The heap and `position` are consistent.
+    ------------------------------------------------------------------------*/
+
+    void swapEntries(int a, int b);
+};
+
+#endif // BESTSELLERS_H
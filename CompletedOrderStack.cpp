@@ -4,14 +4,27 @@
 */
 
 #include "CompletedOrderStack.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include <filesystem>
+
+static const size_t WRITE_CHUNK = 1 << 20;     // Bytes buffered per write
+static const char TRAILER[] = "Total revenue is: $";
 
 //--- Definition of CompletedOrderStack constructor
 CompletedOrderStack::CompletedOrderStack(){
     top = NULL;
+    bottom = NULL;
+    count = 0;
+    revenue = Money();
+
+    savedTop = NULL;
+    trailerOffset = 0;
 }
 
 //--- Definition of CompletedOrderStack destructor
 CompletedOrderStack::~CompletedOrderStack(){
+    METRIC_ADD(COMPLETED_DEPTH, -count);
     NodePtr current = top;
     NodePtr nextNode;
 
@@ -23,6 +36,9 @@ CompletedOrderStack::~CompletedOrderStack(){
     }
 
     top = NULL;
+    bottom = NULL;
+    count = 0;
+    revenue = Money();
 }
 
 //--- Definition of isEmpty()
@@ -32,13 +48,7 @@ bool CompletedOrderStack::isEmpty() const {
 
 //--- Definition of size()
 int CompletedOrderStack::size() const {
-    int size = 0;
-    NodePtr current = top;  // Start from the top of the stack
-    while (current != NULL) {
-        size++;  // Increment size for each node
-        current = current->next;  // Move to the next node
-    }
-    return size;
+    return count;
 }
 
 //--- Definition of getOrder()
@@ -55,90 +65,252 @@ Order CompletedOrderStack::getOrder(int index) const {
     return Order();  // Return a default Order if index is out of bounds
 }
 
-//--- Definition of push()
-void CompletedOrderStack::push(const Order& order){
-    NodePtr newNode = new(nothrow) Node(order);
-    
+//--- Definition of link()
+bool CompletedOrderStack::link(NodePtr newNode){
     if(!newNode){
+        METRIC_INC(ALLOCATION_FAILURES);
         cerr << "Memory Allocation Failed" << endl;
-        return;
+        return false;
     }
     
     newNode->next = top;
+    newNode->prev = NULL;
+    if(top != NULL){
+        top->prev = newNode;
+    } else {
+        bottom = newNode;
+    }
     top = newNode;
+
+    // Keep the aggregates current instead of walking the list later
+    count++;
+    revenue += newNode->data.calculateTotalAmount();
+    METRIC_ADD(COMPLETED_DEPTH, 1);
+    return true;
+}
+
+//--- Definition of push()
+void CompletedOrderStack::push(const Order& order){
+    TRACE_SPAN("CompletedOrderStack::push");
+    link(new(nothrow) Node(order));
+}
+
+//--- Definition of push() taking an rvalue
+void CompletedOrderStack::push(Order&& order){
+    TRACE_SPAN("CompletedOrderStack::push");
+    link(new(nothrow) Node(move(order)));
 }
 
 //--- Definition of pop()
 Order CompletedOrderStack::pop(){
+    TRACE_SPAN("CompletedOrderStack::pop");
     if(isEmpty()){
         return Order();
     }
     
     NodePtr temp = top;
+    if(temp == savedTop)
+        savedTop = temp->next; // Stays in the file, but was saved
     top = top->next;
-    Order data = temp->data;
+    if(top != NULL){
+        top->prev = NULL;
+    } else {
+        bottom = NULL;
+    }
+    count--;
+    revenue -= temp->data.calculateTotalAmount();
+    METRIC_ADD(COMPLETED_DEPTH, -1);
+    Order data = move(temp->data); // Hand the lines over, no copy
     delete temp;
     return data;
 }
 
 //--- Definition of calculateTotalRevenue()
-double CompletedOrderStack::calculateTotalRevenue() const {    
-    double total = 0;
-    NodePtr current = top;
-    
-    // Iterate through the stack and calculate the total
-    while(current != NULL){
-        total += current->data.calculateTotalAmount();
-        current = current->next;
-    }
-    
-    return total;
+Money CompletedOrderStack::calculateTotalRevenue() const {    
+    return revenue;
 }
 
 //--- Definition of saveToFile()
 void CompletedOrderStack::saveToFile(const string& filename) const {
-    ofstream file(filename);
+    TRACE_SPAN("CompletedOrderStack::saveToFile");
+    ofstream file(filename, ios::binary);
     
     if (!file.is_open()) {
         cerr << "Error: Could not open file " << filename << endl;
         return;
     }
     
-    // Traverse the stack and write each order's details
-    Node* current = top;
-
-    while (current != nullptr) {
-        const Order& order = current->data; // Access the order stored in the node
-
-        // Write Order ID and Customer Name
-        file << order.getOrderId() << "," << order.getCustomerName() << ",";
-
-        // Write items name and price seperated by colon and encased in quotes
-        file << "\"";
-        for (int i = 0; i < order.getItemCount(); ++i) { 
-            const MenuItem& item = order.getItem(i);
-            file << item.getName() << ":" << item.getPrice();
-            if (i < order.getItemCount() - 1) {
-                file << "&"; // Separate items with a ampersand
-            }
+    // Traverse the stack from the top and write each order's details,
+    // a large block at a time instead of one flush per line
+    string buffer;
+    for (const_iterator it = begin(); it != end(); ++it) {
+        formatOrder(*it, buffer);
+        if (buffer.size() >= WRITE_CHUNK) {
+            file.write(buffer.data(), buffer.size());
+            buffer.clear();
         }
-        file << "\","; // Close quotes
-
-        // Write total price
-        file << order.calculateTotalAmount() << endl;
-
-        // Move to the next node
-        current = current->next;
     }
 
     // Write total revenue of all orders
-    file << "Total revenue is: $" << calculateTotalRevenue() << endl;
+    buffer += TRAILER;
+    buffer += calculateTotalRevenue().toString();
+    buffer += '\n';
+    file.write(buffer.data(), buffer.size());
     
     file.close(); // Close the file
 }
 
+//--- Definition of formatOrder()
+void CompletedOrderStack::formatOrder(const Order& order, string& out){
+    // Write Order ID and Customer Name
+    out += to_string(order.getOrderId());
+    out += ',';
+    out += order.getCustomerName();
+
+    // Write items name and price seperated by colon and encased in quotes,
+    // one entry per unit so the file lists every item sold
+    out += ",\"";
+    for (int i = 0; i < order.getItemCount(); ++i) {
+        const MenuItem item = order.getItem(i); // Resolves the name once per line
+        string_view name = item.getName();       // Interned, nothing copied
+        string price = item.getPrice().toString();
+        for (int q = 0; q < order.getQuantity(i); ++q) {
+            if (i > 0 || q > 0) {
+                out += '&'; // Separate items with a ampersand
+            }
+            out += name;
+            out += ':';
+            out += price;
+        }
+    }
+    out += "\","; // Close quotes
+
+    // Write total price
+    out += order.calculateTotalAmount().toString();
+    out += '\n';
+}
+
+//--- Definition of appendToFile()
+int CompletedOrderStack::appendToFile(const string& filename, vector<int>* writtenIds){
+    TRACE_SPAN("CompletedOrderStack::appendToFile");
+    if (filename != savedFile) {
+        if (!openTrailer(filename)) {
+            cerr << "Error: Could not open file " << filename << endl;
+            return -1;
+        }
+        savedFile = filename;
+    }
+
+    // Cut the old trailer off; the orders go where it was
+    error_code error;
+    if (filesystem::exists(filename, error))
+        filesystem::resize_file(filename, trailerOffset, error);
+    ofstream file(filename, ios::binary | ios::app);
+    if (error || !file.is_open()) {
+        cerr << "Error: Could not open file " << filename << endl;
+        savedFile.clear(); // Look for the trailer again next time
+        return -1;
+    }
+
+    // Oldest unsaved order first, so the file stays chronological
+    const Node* first = savedTop ? savedTop->prev : bottom;
+    int written = 0;
+    Money added;
+    writeBuffer.clear();
+    for (const Node* node = first; node != NULL; node = node->prev) {
+        // Recovered after a restart, but saved by the run that crashed
+        if (!savedIds.empty() && savedIds.count(node->data.getOrderId()))
+            continue;
+
+        formatOrder(node->data, writeBuffer);
+        added += node->data.calculateTotalAmount();
+        written++;
+        if (writtenIds)
+            writtenIds->push_back(node->data.getOrderId());
+
+        if (writeBuffer.size() >= WRITE_CHUNK) {
+            file.write(writeBuffer.data(), writeBuffer.size());
+            trailerOffset += writeBuffer.size();
+            writeBuffer.clear();
+        }
+    }
+    trailerOffset += writeBuffer.size();
+    savedRevenue += added;
+
+    // The trailer is rewritten after the new orders
+    writeBuffer += TRAILER;
+    writeBuffer += savedRevenue.toString();
+    writeBuffer += '\n';
+    file.write(writeBuffer.data(), writeBuffer.size());
+    file.close();
+
+    if (!file) {
+        cerr << "Error: Could not write file " << filename << endl;
+        savedFile.clear();
+        return -1;
+    }
+
+    savedTop = top;
+    savedIds.clear(); // Every recovered order is below savedTop now
+    return written;
+}
+
+//--- Definition of openTrailer()
+bool CompletedOrderStack::openTrailer(const string& filename){
+    trailerOffset = 0;
+    savedRevenue = Money();
+
+    ifstream file(filename, ios::binary | ios::ate);
+    if (!file.is_open())
+        return !filesystem::exists(filename); // A new file has no trailer
+
+    // The trailer is the last line; only the end of the file is read
+    long long fileSize = file.tellg();
+    long long tailSize = fileSize < 256 ? fileSize : 256;
+    string tail(tailSize, '\0');
+    file.seekg(fileSize - tailSize);
+    if (!file.read(&tail[0], tailSize))
+        return false;
+
+    trailerOffset = fileSize;
+    size_t position = tail.rfind(TRAILER);
+    if (position != string::npos && (position == 0 || tail[position - 1] == '\n')) {
+        const char* amount = tail.data() + position + sizeof(TRAILER) - 1;
+        const char* lineEnd = tail.data() + tail.size();
+        while (lineEnd > amount && (lineEnd[-1] == '\n' || lineEnd[-1] == '\r'))
+            lineEnd--;
+
+        Money total;
+        if (Money::parse(amount, lineEnd, total)) {
+            trailerOffset = fileSize - tailSize + position;
+            savedRevenue = total;
+        }
+    }
+    return true;
+}
+
+//--- Definition of markSaved()
+void CompletedOrderStack::markSaved(int orderId){
+    savedIds.insert(orderId);
+}
+
+//--- Definition of dailyFileName()
+string CompletedOrderStack::dailyFileName(time_t when){
+    tm *time = localtime(&when);
+
+    // Create the file name with the date
+    stringstream filename;
+    filename << "completed_orders (" 
+             << (1900 + time->tm_year) << "-" 
+             << (time->tm_mon + 1) << "-" 
+             << time->tm_mday << ").txt";
+
+    return filename.str();
+}
+
 //--- Definition of display()
 void CompletedOrderStack::display() const {
+    TRACE_SPAN("CompletedOrderStack::display");
     cout << "--- Completed Orders ---" << endl;
     
     if(isEmpty()){
@@ -147,10 +319,8 @@ void CompletedOrderStack::display() const {
     }
     
     // Iterate through the stack and display every completed order
-    NodePtr current = top;
-    while(current != NULL){
-        cout << current->data;
-        current = current->next;
+    for(const_iterator it = begin(); it != end(); ++it){
+        cout << *it;
     }
 }
 
@@ -1,34 +1,62 @@
 /*-- CompletedOrderStack.h -----------------------------------------------------
 
   This header file defines the CompletedOrderStack class, which represents 
-  a stack of completed orders implemented using a singly linked list.
+  a stack of completed orders implemented using a doubly linked list.
 
   Basic operations:
     Constructor:           Initializes an empty stack.
     Destructor:            Releases dynamically allocated memory for the stack.
+                           Nodes come from the shared NodePool, so a warm 
+                           stack pushes and pops without heap allocations.
     isEmpty:               Checks if the stack is empty.
     size:                  Returns the number of orders in the stack.
     getOrder:              Retrieves an order by index without modifying the stack.
-    push:                  Adds a completed order to the top of the stack.
+    Iterators:             Walk the orders without copying them, newest first
+                           (begin/end) or oldest first (rbegin/rend).
+    push:                  Adds a completed order to the top of the stack, by 
+                           copy or by move.
+    emplace:               Constructs an order directly in a node on the top.
     pop:                   Removes and returns the top order from the stack.
     calculateTotalRevenue: Calculates the total revenue from all orders in the stack.
     display:               Outputs the contents of the stack to the console.
     saveToFile:            Saves the stack's contents to a file.
+    appendToFile:          Appends only the orders completed since the last
+                           save, keeping the file's revenue trailer current.
+    markSaved:             Notes a recovered order an earlier run saved.
+    dailyFileName:         Builds the dated file name orders are saved under.
     Overloaded <<:         Outputs the entire stack to an output stream (defined 
                            outside the class).
 
   Class Invariant:
-    1. The stack elements are stored in a singly linked list.
-    2. The `top` pointer points to the most recently added node in the stack.
-    3. If the stack is empty, the `top` pointer is null.
+    1. The stack elements are stored in a doubly linked list; `next` links
+       lead to older orders and `prev` links to newer ones.
+    2. The `top` pointer points to the most recently added node in the stack
+       and the `bottom` pointer to the oldest.
+    3. If the stack is empty, the `top` and `bottom` pointers are null.
+    4. `count` is the number of nodes and `revenue` is the sum of the
+       totals of the Orders in the stack. Both are updated by 
+       every push and pop, so size and revenue queries take constant time.
+    5. `savedTop` is the newest node already written by appendToFile() to
+       `savedFile` (NULL if none); every older node was written too. The
+       file's revenue trailer starts at byte `trailerOffset` and holds
+       `savedRevenue`. Until the next append succeeds, `savedIds` holds
+       the IDs of recovered orders that the run which logged them had
+       saved already, and which are not written again.
 -----------------------------------------------------------------------------*/
 
 #ifndef COMPLETEDORDERSTACK_H
 #define COMPLETEDORDERSTACK_H
 
 #include "Order.h"
+#include "NodePool.h"
 #include <iostream>
+#include <ctime>
 #include <fstream>
+#include <iterator>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
@@ -63,7 +91,7 @@ public:
 
     int size() const;
     /*--------------------------------------------------------------------
-      Calculate the number of elements in the stack.
+      Retrieve the number of elements in the stack in constant time.
 
       Precondition:  None.
       Postcondition: Returns the count of nodes in the stack.
@@ -74,8 +102,10 @@ public:
       Retrieve an Order by its index without modifying the stack.
 
       Precondition:  0 <= index < size().
-      Postcondition: Returns the Order at the specified index. Throws an 
-                     exception if the index is out of bounds.
+      Postcondition: Returns a copy of the Order at the specified index, 
+                     counting from the top, or a default Order if the index
+                     is out of bounds. Takes time proportional to index; use
+                     the iterators to visit every order.
     --------------------------------------------------------------------*/
 
     void push(const Order& order);
@@ -86,22 +116,44 @@ public:
       Postcondition: The specified Order is added to the top of the stack.
     --------------------------------------------------------------------*/
 
+    void push(Order&& order);
+    /*--------------------------------------------------------------------
+      Move an Order to the top of the stack.
+
+      Precondition:  None.
+      Postcondition: The specified Order is moved into a node on the top of
+                     the stack without copying its lines; order is left 
+                     empty.
+    --------------------------------------------------------------------*/
+
+    template <typename... Args>
+    Order* emplace(Args&&... args);
+    /*--------------------------------------------------------------------
+      Construct an Order in place on the top of the stack.
+
+      Precondition:  args are valid arguments for an Order constructor.
+      Postcondition: A new Order built from args is added to the top of the
+                     stack. Returns a pointer to it so items can be added, 
+                     or NULL if memory allocation failed.
+    --------------------------------------------------------------------*/
+
     Order pop();
     /*--------------------------------------------------------------------
       Remove and return the Order at the top of the stack.
 
       Precondition:  The stack is not empty.
-      Postcondition: The Order at the top of the stack is removed and returned.
-                     Throws an exception if the stack is empty.
+      Postcondition: The Order at the top of the stack is removed and moved
+                     out to the caller. Returns a default Order if the stack
+                     is empty.
     --------------------------------------------------------------------*/
 
-    double calculateTotalRevenue() const;
+    Money calculateTotalRevenue() const;
     /*--------------------------------------------------------------------
-      Calculate the total revenue of all orders in the stack.
+      Retrieve the total revenue of all orders in the stack in constant time.
 
       Precondition:  None.
-      Postcondition: Returns the sum of the total amounts for all Orders 
-                     stored in the stack.
+      Postcondition: Returns the exact sum of the total amounts for all 
+                     Orders stored in the stack.
     --------------------------------------------------------------------*/
 
     void display() const;
@@ -119,7 +171,43 @@ public:
 
       Precondition:  The file specified by `filename` is writable.
       Postcondition: All Orders in the stack are written to the file, starting
-                     from the top.
+                     from the top, replacing its contents.
+    --------------------------------------------------------------------*/
+
+    int appendToFile(const string& filename, vector<int>* writtenIds = NULL);
+    /*--------------------------------------------------------------------
+      Save the Orders completed since the last call, in time proportional
+      to their number.
+
+      Precondition:  The file specified by `filename` is writable.
+      Postcondition: The "Total revenue is:" trailer of the file, if it has
+                     one, is cut off; the new Orders are appended oldest
+                     first, in the saveToFile() line format, followed by a
+                     trailer with the previous file revenue plus theirs.
+                     A file saved by an earlier run is continued, not
+                     overwritten, and Orders passed to markSaved() are
+                     not written again. Returns the number of Orders
+                     written, and adds their IDs to writtenIds if given,
+                     or returns -1 after reporting an error.
+    --------------------------------------------------------------------*/
+
+    void markSaved(int orderId);
+    /*--------------------------------------------------------------------
+      Note that an Order recovered from the order log was saved by the run
+      that logged it.
+
+      Precondition:  The Order with ID orderId is on the stack, pushed
+                     since the last successful appendToFile().
+      Postcondition: The next appendToFile() skips the Order.
+    --------------------------------------------------------------------*/
+
+    static string dailyFileName(time_t when);
+    /*--------------------------------------------------------------------
+      Build the name of the completed orders file for a given day.
+
+      Precondition:  None.
+      Postcondition: Returns "completed_orders (YYYY-M-D).txt" for the local
+                     date of when.
     --------------------------------------------------------------------*/
 
 private:
@@ -127,23 +215,174 @@ private:
     class Node {
     public:
         Order data;  // The Order stored in this Node
-        Node* next;  // Pointer to the next Node in the stack
+        Node* next;  // Pointer to the next (older) Node in the stack
+        Node* prev;  // Pointer to the previous (newer) Node in the stack
 
-        Node(const Order& data) : data(data), next(NULL) {}
+        Node(const Order& data) : data(data), next(NULL), prev(NULL) {}
+        Node(Order&& data) : data(move(data)), next(NULL), prev(NULL) {}
         /*--------------------------------------------------------------------
-          Construct a Node with the given Order.
+          Construct a Node with the given Order, copied or moved.
 
           Precondition:  None.
           Postcondition: A Node is created with the specified Order, and the 
-                         next pointer is initialized to NULL.
+                         links are initialized to NULL.
+        --------------------------------------------------------------------*/
+
+        template <typename... Args>
+        Node(in_place_t, Args&&... args) 
+            : data(forward<Args>(args)...), next(NULL), prev(NULL) {}
+        /*--------------------------------------------------------------------
+          Construct a Node whose Order is built in place from args.
+
+          Precondition:  args are valid arguments for an Order constructor.
+          Postcondition: A Node is created holding Order(args...), and the
+                         links are initialized to NULL.
+        --------------------------------------------------------------------*/
+
+        static void* operator new(size_t bytes){
+            void* block = NodePool::shared().allocate(bytes);
+            if(!block)
+                throw bad_alloc();
+            return block;
+        }
+        static void* operator new(size_t bytes, const nothrow_t&) noexcept {
+            return NodePool::shared().allocate(bytes);
+        }
+        static void operator delete(void* block, size_t bytes){
+            NodePool::shared().deallocate(block, bytes);
+        }
+        static void operator delete(void* block, const nothrow_t&) noexcept {
+            NodePool::shared().deallocate(block, sizeof(Node));
+        }
+        /*--------------------------------------------------------------------
+          Nodes are allocated from the shared NodePool instead of the heap.
+
+          Precondition:  None.
+          Postcondition: new returns a recycled or slab block (or NULL for 
+                         the nothrow form when memory is exhausted); delete
+                         returns the block to the pool.
         --------------------------------------------------------------------*/
     };
 
     typedef Node* NodePtr;
     
-    NodePtr top;  // Pointer to the top Node in the stack
+    NodePtr top;             // Pointer to the top Node in the stack
+    NodePtr bottom;          // Pointer to the bottom (oldest) Node in the stack
+    int count;               // Number of Nodes in the stack
+    Money revenue;           // Sum of the Order totals in the stack
+
+    const Node* savedTop;    // Newest Node written by appendToFile()
+    string savedFile;        // File appendToFile() last wrote to
+    long long trailerOffset; // Where the revenue trailer of savedFile starts
+    Money savedRevenue;      // Revenue recorded in that trailer
+    unordered_set<int> savedIds; // Recovered orders saved before the restart
+    string writeBuffer;      // Reused to batch the writes of appendToFile()
+
+    static void formatOrder(const Order& order, string& out);
+    /*--------------------------------------------------------------------
+      Append the file line of an Order to a buffer.
+
+      Precondition:  None.
+      Postcondition: out ends with "id,customer,"Name:price&...",total"
+                     and a newline, one Name:price entry per unit.
+    --------------------------------------------------------------------*/
+
+    bool openTrailer(const string& filename);
+    /*--------------------------------------------------------------------
+      Find the revenue trailer of a file appendToFile() is switching to.
+
+      Precondition:  None.
+      Postcondition: trailerOffset and savedRevenue describe the file's
+                     last "Total revenue is: $" line, or its end and zero
+                     if it has none or does not exist yet. Returns false
+                     if the file exists but cannot be read.
+    --------------------------------------------------------------------*/
+
+    bool link(NodePtr newNode);
+    /*--------------------------------------------------------------------
+      Place a newly allocated node on the top of the stack.
+
+      Precondition:  newNode is NULL or a node not yet in any stack.
+      Postcondition: newNode becomes the top of the stack and is added to
+                     the count and revenue. Returns false, after reporting
+                     the failure, if newNode is NULL.
+    --------------------------------------------------------------------*/
+
+public:
+    /***** Iterators *****/
+    class const_iterator {
+    public:
+        typedef bidirectional_iterator_tag iterator_category;
+        typedef Order value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const Order* pointer;
+        typedef const Order& reference;
+
+        const_iterator() : node(NULL), stack(NULL) {}
+
+        reference operator*() const { return node->data; }
+        pointer operator->() const { return &node->data; }
+
+        const_iterator& operator++() { node = node->next; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++*this; return old; }
+
+        // Stepping back from end() lands on the bottom (oldest) order
+        const_iterator& operator--() { node = node ? node->prev : stack->bottom; return *this; }
+        const_iterator operator--(int) { const_iterator old = *this; --*this; return old; }
+
+        bool operator==(const const_iterator& other) const { return node == other.node; }
+        bool operator!=(const const_iterator& other) const { return node != other.node; }
+        /*--------------------------------------------------------------------
+          Bidirectional iterator over the Orders of a stack. ++ moves toward
+          older orders, -- toward newer ones.
+
+          Precondition:  The iterator is dereferenceable for *, -> and ++,
+                         and not begin() for --.
+          Postcondition: Yields the stored Order by reference, without copying.
+        --------------------------------------------------------------------*/
+
+    private:
+        friend class CompletedOrderStack;
+        const_iterator(const Node* node, const CompletedOrderStack* stack)
+            : node(node), stack(stack) {}
+
+        const Node* node;                  // Current Node, NULL at end()
+        const CompletedOrderStack* stack;  // Stack being iterated
+    };
+
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    const_iterator begin() const { return const_iterator(top, this); }
+    const_iterator end() const { return const_iterator(NULL, this); }
+    /*--------------------------------------------------------------------
+      Iterate over the Orders from the top (newest) to the bottom (oldest).
+
+      Precondition:  The stack is not modified during the iteration.
+      Postcondition: Returns an iterator to the top Order, or past the 
+                     bottom Order.
+    --------------------------------------------------------------------*/
+
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+    /*--------------------------------------------------------------------
+      Iterate over the Orders in chronological order, oldest first.
+
+      Precondition:  The stack is not modified during the iteration.
+      Postcondition: Returns an iterator to the bottom Order, or past the 
+                     top Order.
+    --------------------------------------------------------------------*/
 };
 
+/***** Template Definitions *****/
+template <typename... Args>
+Order* CompletedOrderStack::emplace(Args&&... args){
+    NodePtr newNode = new(nothrow) Node(in_place, forward<Args>(args)...);
+    if(!link(newNode))
+        return NULL;
+
+    return &newNode->data;
+}
+
 /***** Overloaded Operators *****/
 ostream& operator<<(ostream& out, const CompletedOrderStack& completedOrderStack);
 /*--------------------------------------------------------------------
@@ -0,0 +1,413 @@
+/*-- ConcurrentOrderQueue.cpp ------------------------------------------------
+              This file implements ConcurrentOrderQueue member functions
+              and the hazard pointers used to reclaim its nodes.
+--------------------------------------------------------------------------*/
+
+#include "ConcurrentOrderQueue.h"
+#include "Metrics.h"
+#include "NodePool.h"
+#include "Trace.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+/***** Hazard Pointers *****/
+
+// Every thread that touches a queue owns one record. A thread publishes in
+// its record the nodes it is about to dereference; a retired node is only
+// deleted when it is not published in any record. Records are never freed,
+// they are released when their thread exits and reused by later threads,
+// together with any nodes the previous owner retired but could not free yet.
+
+static const int HAZARDS_PER_THREAD = 2; // Node being read and its successor
+static const size_t SCAN_THRESHOLD = 64; // Retired nodes that trigger a scan
+
+struct RetiredNode {
+    void* node;               // Unlinked node
+    void (*destroy)(void*);   // Deletes it with the right type
+};
+
+struct HazardRecord {
+    atomic<void*> hazards[HAZARDS_PER_THREAD]; // Published pointers
+    atomic<bool> active;                      // Owned by a live thread
+    HazardRecord* next;                       // Next record in the list
+    vector<RetiredNode> retired;              // Owner's nodes awaiting deletion
+    vector<void*> published;                  // Reused by the owner's scans
+
+    HazardRecord() : active(true), next(NULL) {
+        for(int i = 0; i < HAZARDS_PER_THREAD; i++)
+            hazards[i].store(NULL);
+    }
+};
+
+static atomic<HazardRecord*> hazardRecords(NULL); // All records, never shrinks
+
+// Claims a free record, or adds a new one, for the calling thread
+static HazardRecord* acquireRecord(){
+    for(HazardRecord* record = hazardRecords.load(); record != NULL;
+            record = record->next){
+        bool expected = false;
+        if(!record->active.load(memory_order_relaxed)
+            && record->active.compare_exchange_strong(expected, true))
+            return record;
+    }
+
+    HazardRecord* record = new HazardRecord();
+    HazardRecord* first = hazardRecords.load();
+    do {
+        record->next = first;
+    } while(!hazardRecords.compare_exchange_weak(first, record));
+
+    return record;
+}
+
+// Releases the calling thread's record when the thread exits
+struct HazardOwner {
+    HazardRecord* record;
+
+    HazardOwner() : record(acquireRecord()) {}
+    ~HazardOwner(){
+        for(int i = 0; i < HAZARDS_PER_THREAD; i++)
+            record->hazards[i].store(NULL, memory_order_release);
+        record->active.store(false, memory_order_release);
+    }
+};
+
+static HazardRecord* localRecord(){
+    thread_local HazardOwner owner;
+    return owner.record;
+}
+
+// Publishes the current value of source in the given hazard slot and
+// returns it once it is certain the value was not retired in between
+template <typename T>
+static T* protect(int slot, const atomic<T*>& source){
+    HazardRecord* record = localRecord();
+    T* pointer = source.load(memory_order_acquire);
+    while(true){
+        record->hazards[slot].store(pointer, memory_order_seq_cst);
+        T* again = source.load(memory_order_acquire);
+        if(again == pointer)
+            return pointer;
+        pointer = again;
+    }
+}
+
+static void clearHazards(){
+    HazardRecord* record = localRecord();
+    for(int i = 0; i < HAZARDS_PER_THREAD; i++)
+        record->hazards[i].store(NULL, memory_order_release);
+}
+
+// Deletes every retired node of the calling thread that no record publishes
+static void scan(HazardRecord* self){
+    vector<void*>& published = self->published;
+    published.clear();
+    for(HazardRecord* record = hazardRecords.load(); record != NULL;
+            record = record->next){
+        for(int i = 0; i < HAZARDS_PER_THREAD; i++){
+            void* pointer = record->hazards[i].load(memory_order_seq_cst);
+            if(pointer != NULL)
+                published.push_back(pointer);
+        }
+    }
+    sort(published.begin(), published.end());
+
+    // Keep the nodes still published at the front, in place
+    size_t kept = 0;
+    for(size_t i = 0; i < self->retired.size(); i++){
+        RetiredNode& retired = self->retired[i];
+        if(binary_search(published.begin(), published.end(), retired.node)){
+            self->retired[kept++] = retired;
+        } else {
+            retired.destroy(retired.node);
+        }
+    }
+    self->retired.resize(kept);
+}
+
+/***** Node Free Lists *****/
+
+// Every thread keeps the nodes it deleted on its own list and allocates
+// from it without synchronization. Producers allocate what consumers
+// delete, so lists hand batches of CACHE_BATCH nodes to a shared depot
+// when they grow past two batches, and take one back when they run dry.
+// Nodes are only put on a list after their hazard pointer scan, so a
+// recycled node can no longer be read by a thread that saw it earlier.
+
+static const int CACHE_BATCH = 64; // Nodes moved to or from the depot at once
+
+struct FreeNode {
+    FreeNode* next;
+};
+
+struct NodeBatch {
+    FreeNode* first;
+    int count;
+};
+
+// Batches waiting for a thread that runs out; never destroyed, so lists
+// of threads that exit late can still hand their nodes back
+struct NodeDepot {
+    mutex depotLock;
+    vector<NodeBatch> batches;
+
+    void put(FreeNode* first, int count){
+        if(first == NULL)
+            return;
+        lock_guard<mutex> guard(depotLock);
+        NodeBatch batch = { first, count };
+        batches.push_back(batch);
+    }
+
+    bool take(NodeBatch& batch){
+        lock_guard<mutex> guard(depotLock);
+        if(batches.empty())
+            return false;
+        batch = batches.back();
+        batches.pop_back();
+        return true;
+    }
+};
+
+static NodeDepot& depot(){
+    static NodeDepot* instance = new NodeDepot();
+    return *instance;
+}
+
+// The free list of one thread, given to the depot when the thread exits
+struct NodeCache {
+    FreeNode* first;
+    int count;
+
+    NodeCache() : first(NULL), count(0) {}
+    ~NodeCache(){
+        depot().put(first, count);
+    }
+};
+
+static NodeCache& localCache(){
+    thread_local NodeCache cache;
+    return cache;
+}
+
+// Takes a node from the calling thread's list, refilling it from the depot
+static void* allocateNode(size_t bytes){
+    NodeCache& cache = localCache();
+    if(cache.first == NULL){
+        NodeBatch batch;
+        if(!depot().take(batch))
+            return NodePool::shared().allocate(bytes); // Still warming up
+        cache.first = batch.first;
+        cache.count = batch.count;
+    }
+
+    FreeNode* node = cache.first;
+    cache.first = node->next;
+    cache.count--;
+    return node;
+}
+
+// Puts a node on the calling thread's list, moving a batch to the depot
+// once the list holds two
+static void releaseNode(void* block){
+    if(block == NULL)
+        return;
+
+    NodeCache& cache = localCache();
+    FreeNode* node = static_cast<FreeNode*>(block);
+    node->next = cache.first;
+    cache.first = node;
+    cache.count++;
+
+    if(cache.count >= 2 * CACHE_BATCH){
+        FreeNode* last = cache.first;
+        for(int i = 1; i < CACHE_BATCH; i++)
+            last = last->next;
+        FreeNode* batch = cache.first;
+        cache.first = last->next;
+        cache.count -= CACHE_BATCH;
+        last->next = NULL;
+        depot().put(batch, CACHE_BATCH);
+    }
+}
+
+//--- Definition of Node::operator new()
+void* ConcurrentOrderQueue::Node::operator new(size_t bytes){
+    void* block = allocateNode(bytes);
+    if(!block)
+        throw bad_alloc();
+    return block;
+}
+
+//--- Definition of Node::operator new() without exceptions
+void* ConcurrentOrderQueue::Node::operator new(size_t bytes, const nothrow_t&) noexcept {
+    return allocateNode(bytes);
+}
+
+//--- Definition of Node::operator delete()
+void ConcurrentOrderQueue::Node::operator delete(void* block){
+    releaseNode(block);
+}
+
+//--- Definition of Node::operator delete() without exceptions
+void ConcurrentOrderQueue::Node::operator delete(void* block, const nothrow_t&) noexcept {
+    releaseNode(block);
+}
+
+/***** ConcurrentOrderQueue *****/
+
+//--- Definition of ConcurrentOrderQueue constructor
+ConcurrentOrderQueue::ConcurrentOrderQueue(){
+    Node* dummy = new Node();
+    head.store(dummy);
+    tail.store(dummy);
+}
+
+//--- Definition of ConcurrentOrderQueue destructor
+ConcurrentOrderQueue::~ConcurrentOrderQueue(){
+    Node* current = head.load();
+    Node* nextNode;
+
+    // Delete the dummy and every remaining node with its Order
+    while(current != NULL){
+        nextNode = current->next.load();
+        delete current;
+        if(nextNode != NULL)
+            METRIC_ADD(QUEUE_DEPTH, -1); // A waiting order went with it
+        current = nextNode;
+    }
+}
+
+//--- Definition of retire()
+void ConcurrentOrderQueue::retire(Node* node){
+    HazardRecord* record = localRecord();
+
+    RetiredNode retired;
+    retired.node = node;
+    retired.destroy = [](void* pointer){ delete static_cast<Node*>(pointer); };
+    record->retired.push_back(retired);
+
+    if(record->retired.size() >= SCAN_THRESHOLD)
+        scan(record);
+}
+
+//--- Definition of isEmpty()
+bool ConcurrentOrderQueue::isEmpty() const {
+    Node* first = protect(0, head);
+    bool empty = first->next.load(memory_order_acquire) == NULL;
+    clearHazards();
+    return empty;
+}
+
+//--- Definition of link()
+void ConcurrentOrderQueue::link(Node* newNode){
+    while(true){
+        Node* last = protect(0, tail);
+        Node* next = last->next.load(memory_order_acquire);
+        if(last != tail.load(memory_order_acquire))
+            continue; // tail moved while we were reading it
+
+        if(next == NULL){
+            // Try to link the node after the last one
+            if(last->next.compare_exchange_weak(next, newNode,
+                    memory_order_release, memory_order_relaxed)){
+                // Swing tail; if this fails another thread already did it
+                tail.compare_exchange_strong(last, newNode,
+                    memory_order_release, memory_order_relaxed);
+                break;
+            }
+        } else {
+            // tail is lagging behind, help advance it
+            tail.compare_exchange_strong(last, next,
+                memory_order_release, memory_order_relaxed);
+        }
+    }
+
+    clearHazards();
+}
+
+//--- Definition of enqueue()
+void ConcurrentOrderQueue::enqueue(const Order& order){
+    TRACE_SPAN("ConcurrentOrderQueue::enqueue");
+    Node* newNode = new(nothrow) Node(order);
+
+    if(!newNode){
+        METRIC_INC(ALLOCATION_FAILURES);
+        cerr << "Memory Allocation Failed" << endl;
+        return;
+    }
+
+    newNode->data.stamp(Order::ENQUEUED);
+    link(newNode);
+    METRIC_INC(ORDERS_ENQUEUED);
+    METRIC_ADD(QUEUE_DEPTH, 1);
+}
+
+//--- Definition of enqueue() taking an rvalue
+void ConcurrentOrderQueue::enqueue(Order&& order){
+    TRACE_SPAN("ConcurrentOrderQueue::enqueue");
+    Node* newNode = new(nothrow) Node(move(order));
+
+    if(!newNode){
+        METRIC_INC(ALLOCATION_FAILURES);
+        cerr << "Memory Allocation Failed" << endl;
+        return;
+    }
+
+    newNode->data.stamp(Order::ENQUEUED);
+    link(newNode);
+    METRIC_INC(ORDERS_ENQUEUED);
+    METRIC_ADD(QUEUE_DEPTH, 1);
+}
+
+//--- Definition of tryDequeue()
+bool ConcurrentOrderQueue::tryDequeue(Order& order){
+    TRACE_SPAN("ConcurrentOrderQueue::tryDequeue");
+    Node* first;
+    Node* next;
+
+    while(true){
+        first = protect(0, head);
+        Node* last = tail.load(memory_order_acquire);
+        next = protect(1, first->next);
+        if(first != head.load(memory_order_acquire))
+            continue; // head moved while we were reading it
+
+        if(next == NULL){
+            clearHazards();
+            return false; // Only the dummy is left
+        }
+
+        if(first == last){
+            // tail is lagging behind, help advance it before moving head
+            tail.compare_exchange_strong(last, next,
+                memory_order_release, memory_order_relaxed);
+            continue;
+        }
+
+        // next becomes the new dummy; whoever moves head owns its Order
+        if(head.compare_exchange_weak(first, next,
+                memory_order_acq_rel, memory_order_relaxed))
+            break;
+    }
+
+    // Losing threads never read data, and the hazard on next keeps the
+    // node alive even if other threads dequeue past it meanwhile
+    order = move(next->data);
+    order.setStatus('C');
+    order.stamp(Order::DEQUEUED);
+    METRIC_INC(ORDERS_DEQUEUED);
+    METRIC_ADD(QUEUE_DEPTH, -1);
+
+    clearHazards();
+    retire(first);
+    return true;
+}
+
+//--- Definition of dequeue()
+Order ConcurrentOrderQueue::dequeue(){
+    Order order;
+    tryDequeue(order);
+    return order;
+}
@@ -0,0 +1,157 @@
+/*-- ConcurrentOrderQueue.h --------------------------------------------------
+
+  This header file defines the ConcurrentOrderQueue class, a lock-free queue
+  of Order objects that any number of threads may enqueue to and dequeue
+  from at the same time. It follows the Michael-Scott design: a singly
+  linked list with a dummy head node, where `head` and `tail` are advanced
+  with compare-and-swap. Removed nodes are reclaimed with hazard pointers, so
+  a node is only freed once no thread can still be reading it.
+
+  Basic operations:
+    Constructor:       Initializes an empty queue.
+    Destructor:        Releases the nodes and Orders still in the queue.
+    isEmpty:           Checks if the queue is empty.
+    enqueue:           Adds an Order to the rear of the queue.
+    tryDequeue:        Removes the Order at the front of the queue, if any.
+    dequeue:           Removes and returns the Order at the front of the queue.
+
+  Class Invariant:
+    1. `head` points to a dummy node; the Orders in the queue are held by
+       the nodes after it, in arrival order.
+    2. `tail` points to the last node or, briefly, to the node before it.
+    3. Each Order is stored in its node. Only the dequeuing thread that
+       wins the compare-and-swap on `head` reads it, moving it out of the
+       node that has just become the new dummy.
+    4. A node unlinked from the queue is retired and deleted only when no
+       thread's hazard pointer refers to it.
+    5. Node memory comes from the shared NodePool and is recycled through
+       per-thread free lists: a deleted node goes to the list of the thread
+       that deleted it, and lists trade whole batches of nodes through a
+       shared depot, so a warm queue allocates without touching the heap or
+       a lock on most operations. Node memory is kept by the queues, never
+       returned to the pool.
+-----------------------------------------------------------------------------*/
+
+#ifndef CONCURRENTORDERQUEUE_H
+#define CONCURRENTORDERQUEUE_H
+
+#include "Order.h"
+#include <atomic>
+#include <new>
+
+using namespace std;
+
+class ConcurrentOrderQueue {
+public:
+    /***** Constructor and Destructor *****/
+    ConcurrentOrderQueue();
+    /*--------------------------------------------------------------------
+      Construct an empty ConcurrentOrderQueue.
+
+      Precondition:  None.
+      Postcondition: `head` and `tail` point to a single dummy node.
+    --------------------------------------------------------------------*/
+
+    ~ConcurrentOrderQueue();
+    /*--------------------------------------------------------------------
+      Destructor: Releases the nodes and Orders still in the queue.
+
+      Precondition:  No other thread is using the queue.
+      Postcondition: All nodes in the queue and their Orders are deleted.
+                     Nodes retired earlier are freed by the hazard pointer
+                     scans of the threads that retired them.
+    --------------------------------------------------------------------*/
+
+    /***** Queue Operations *****/
+    bool isEmpty() const;
+    /*--------------------------------------------------------------------
+      Check if the queue is empty.
+
+      Precondition:  None.
+      Postcondition: Returns true if the queue held no Orders at the moment
+                     it was inspected. Other threads may change that at any
+                     time, so use tryDequeue() to take an Order.
+    --------------------------------------------------------------------*/
+
+    void enqueue(const Order& order);
+    void enqueue(Order&& order);
+    /*--------------------------------------------------------------------
+      Add an Order to the rear of the queue, by copy or by move.
+
+      Precondition:  None.
+      Postcondition: The Order is in the queue after every Order whose
+                     enqueue completed before this one started. Reports the
+                     failure if memory allocation failed.
+    --------------------------------------------------------------------*/
+
+    bool tryDequeue(Order& order);
+    /*--------------------------------------------------------------------
+      Remove the Order at the front of the queue, if there is one.
+
+      Precondition:  None.
+      Postcondition: Returns true and moves the front Order into order, with
+                     its status set to 'C'. Returns false, leaving order
+                     unchanged, if the queue was empty.
+    --------------------------------------------------------------------*/
+
+    Order dequeue();
+    /*--------------------------------------------------------------------
+      Remove and return the Order at the front of the queue.
+
+      Precondition:  None.
+      Postcondition: Returns the front Order with its status set to 'C', or
+                     a default Order if the queue was empty.
+    --------------------------------------------------------------------*/
+
+private:
+    /***** Nested Node Structure *****/
+    struct Node {
+        Order data;           // Order held by this node, moved out once dequeued
+        atomic<Node*> next;   // Pointer to the next Node in the queue
+
+        Node() : next(NULL) {}
+        Node(const Order& data) : data(data), next(NULL) {}
+        Node(Order&& data) : data(move(data)), next(NULL) {}
+
+        static void* operator new(size_t bytes);
+        static void* operator new(size_t bytes, const nothrow_t&) noexcept;
+        static void operator delete(void* block);
+        static void operator delete(void* block, const nothrow_t&) noexcept;
+        /*--------------------------------------------------------------------
+          Nodes are allocated from the calling thread's free list.
+
+          Precondition:  delete is only called once no hazard pointer can
+                         refer to the node.
+          Postcondition: new returns a recycled block, or a block of the
+                         shared NodePool when the thread and the depot have
+                         none (NULL for the nothrow form when memory is
+                         exhausted); delete puts the block on the calling
+                         thread's free list.
+        --------------------------------------------------------------------*/
+    };
+
+    atomic<Node*> head;  // Dummy node before the front Order
+    atomic<Node*> tail;  // Last node, or the one before it
+
+    void link(Node* newNode);
+    /*--------------------------------------------------------------------
+      Append a new node at the rear of the queue.
+
+      Precondition:  newNode is not yet reachable by other threads.
+      Postcondition: newNode is linked after the last node, and `tail` has
+                     been advanced past it by this or another thread.
+    --------------------------------------------------------------------*/
+
+    static void retire(Node* node);
+    /*--------------------------------------------------------------------
+      Hand an unlinked node over to hazard pointer reclamation.
+
+      Precondition:  node is no longer reachable from `head`.
+      Postcondition: node is deleted once no hazard pointer refers to it.
+    --------------------------------------------------------------------*/
+
+    ConcurrentOrderQueue(const ConcurrentOrderQueue& other) = delete;
+    ConcurrentOrderQueue& operator=(const ConcurrentOrderQueue& other) = delete;
+};
+
+#endif // CONCURRENTORDERQUEUE_H
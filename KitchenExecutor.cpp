@@ -0,0 +1,243 @@
+/*-- KitchenExecutor.cpp -----------------------------------------------------
+              This file implements KitchenExecutor member functions.
+--------------------------------------------------------------------------*/
+
+#include "KitchenExecutor.h"
+#include "Trace.h"
+#include <chrono>
+#include <iomanip>
+
+//--- Definition of KitchenExecutor constructor
+KitchenExecutor::KitchenExecutor(int workerCount, PrepareFunction prepare)
+    : prepare(prepare), queued(0), stopping(false), inFlight(0),
+      completed(NULL) {
+    if(workerCount <= 0)
+        workerCount = (int)thread::hardware_concurrency();
+    if(workerCount <= 0)
+        workerCount = 1; // Hardware concurrency is unknown
+
+    for(int i = 0; i < workerCount; i++){
+        Worker* worker = new Worker();
+        worker->stats.ordersPrepared = 0;
+        worker->stats.ordersStolen = 0;
+        worker->stats.busySeconds = 0;
+        workers.push_back(worker);
+    }
+
+    // Start the threads only once every deque exists, they steal from all
+    for(int i = 0; i < workerCount; i++){
+        workers[i]->handle = thread(&KitchenExecutor::run, this, i);
+    }
+}
+
+//--- Definition of KitchenExecutor destructor
+KitchenExecutor::~KitchenExecutor(){
+    shutdown();
+
+    for(size_t i = 0; i < workers.size(); i++){
+        delete workers[i];
+    }
+}
+
+//--- Definition of shutdown()
+void KitchenExecutor::shutdown(){
+    {
+        lock_guard<mutex> guard(wakeLock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for(size_t i = 0; i < workers.size(); i++){
+        if(workers[i]->handle.joinable())
+            workers[i]->handle.join();
+    }
+}
+
+//--- Definition of drain()
+int KitchenExecutor::drain(OrderQueue& queue, CompletedOrderStack& completed){
+    TRACE_SPAN("KitchenExecutor::drain");
+    this->completed = &completed;
+
+    // Deal the orders out round-robin; workers start on the first one
+    // while the rest are still being dealt
+    int dealt = 0;
+    while(!queue.isEmpty()){
+        Order order = queue.dequeue();
+        Worker* worker = workers[dealt % workers.size()];
+
+        inFlight++;
+        {
+            lock_guard<mutex> guard(worker->lock);
+            worker->orders.push_back(move(order));
+        }
+        {
+            lock_guard<mutex> guard(wakeLock);
+            queued++;
+        }
+        wake.notify_one();
+        dealt++;
+    }
+
+    // Wait for the last order to be completed
+    unique_lock<mutex> guard(doneLock);
+    done.wait(guard, [this]{ return inFlight.load() == 0; });
+
+    return dealt;
+}
+
+//--- Definition of takeOrder()
+bool KitchenExecutor::takeOrder(int self, Order& order){
+    Worker* own = workers[self];
+    {
+        // Own orders first, oldest first
+        lock_guard<mutex> guard(own->lock);
+        if(!own->orders.empty()){
+            order = move(own->orders.front());
+            own->orders.pop_front();
+            return true;
+        }
+    }
+
+    // Steal the newest order of the next worker that has any. Only one
+    // deque lock is held at a time, so two thieves cannot deadlock.
+    int count = (int)workers.size();
+    for(int i = 1; i < count; i++){
+        Worker* victim = workers[(self + i) % count];
+        bool stolen = false;
+        {
+            lock_guard<mutex> guard(victim->lock);
+            if(!victim->orders.empty()){
+                order = move(victim->orders.back());
+                victim->orders.pop_back();
+                stolen = true;
+            }
+        }
+
+        if(stolen){
+            lock_guard<mutex> guard(own->lock);
+            own->stats.ordersStolen++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//--- Definition of run()
+void KitchenExecutor::run(int self){
+    Worker* worker = workers[self];
+    Order order;
+    Trace::setThreadName("kitchen worker");
+
+    while(true){
+        if(takeOrder(self, order)){
+            TRACE_SPAN("prepare order");
+            queued--;
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+            if(prepare)
+                prepare(order);
+            order.setStatus('C');
+            order.stamp(Order::COMPLETED);
+
+            // Orders that skipped a stage (not enqueued, or recovered from
+            // the log) have no wait for it
+            long long created = order.getTimestamp(Order::CREATED);
+            long long enqueued = order.getTimestamp(Order::ENQUEUED);
+            long long dequeued = order.getTimestamp(Order::DEQUEUED);
+            long long finished = order.getTimestamp(Order::COMPLETED);
+            if(enqueued && dequeued)
+                queueWait.record(dequeued - enqueued);
+            if(dequeued)
+                kitchenTime.record(finished - dequeued);
+            if(created)
+                timeToComplete.record(finished - created);
+
+            // Each order gets its own track in the trace
+            if(Trace::isEnabled()){
+                if(created)
+                    Trace::orderInterval("order", order.getOrderId(), created, finished);
+                if(enqueued && dequeued)
+                    Trace::orderInterval("queue wait", order.getOrderId(), enqueued, dequeued);
+            }
+
+            {
+                lock_guard<mutex> guard(completedLock);
+                completed->push(move(order));
+            }
+
+            double seconds = chrono::duration<double>(
+                chrono::steady_clock::now() - start).count();
+            {
+                lock_guard<mutex> guard(worker->lock);
+                worker->stats.ordersPrepared++;
+                worker->stats.busySeconds += seconds;
+            }
+
+            // The last order of a drain wakes up the dispatcher
+            if(--inFlight == 0){
+                lock_guard<mutex> guard(doneLock);
+                done.notify_all();
+            }
+            continue;
+        }
+
+        // Nothing to do: sleep until orders arrive or the kitchen closes
+        unique_lock<mutex> guard(wakeLock);
+        wake.wait(guard, [this]{ return stopping || queued.load() > 0; });
+        if(stopping && queued.load() == 0)
+            return;
+    }
+}
+
+//--- Definition of getWorkerCount()
+int KitchenExecutor::getWorkerCount() const {
+    return (int)workers.size();
+}
+
+//--- Definition of getWorkerStats()
+KitchenExecutor::WorkerStats KitchenExecutor::getWorkerStats(int worker) const {
+    lock_guard<mutex> guard(workers[worker]->lock);
+    return workers[worker]->stats;
+}
+
+//--- Definition of getQueueWait()
+const LatencyHistogram& KitchenExecutor::getQueueWait() const {
+    return queueWait;
+}
+
+//--- Definition of getKitchenTime()
+const LatencyHistogram& KitchenExecutor::getKitchenTime() const {
+    return kitchenTime;
+}
+
+//--- Definition of getTimeToComplete()
+const LatencyHistogram& KitchenExecutor::getTimeToComplete() const {
+    return timeToComplete;
+}
+
+//--- Definition of printLatency()
+void KitchenExecutor::printLatency(ostream& out) const {
+    LatencyHistogram::printHeader(out);
+    queueWait.print(out, "Queue wait");
+    kitchenTime.print(out, "In kitchen");
+    timeToComplete.print(out, "Time to complete");
+}
+
+//--- Definition of printStats()
+void KitchenExecutor::printStats(ostream& out) const {
+    out << "Worker  Prepared  Stolen  Busy (ms)  Orders/s" << endl;
+
+    for(int i = 0; i < getWorkerCount(); i++){
+        WorkerStats stats = getWorkerStats(i);
+        double rate = stats.busySeconds > 0
+            ? stats.ordersPrepared / stats.busySeconds : 0;
+
+        out << setw(6) << i + 1 << setw(10) << stats.ordersPrepared
+            << setw(8) << stats.ordersStolen
+            << setw(11) << fixed << setprecision(3) << stats.busySeconds * 1000
+            << setw(10) << setprecision(0) << rate << endl;
+        out.unsetf(ios::fixed);
+        out << setprecision(6);
+    }
+}
@@ -0,0 +1,207 @@
+/*-- KitchenExecutor.h -------------------------------------------------------
+
+  This header file defines the KitchenExecutor class, a pool of kitchen
+  worker threads that prepares pending orders in parallel. Each worker owns
+  a work-stealing deque: the dispatching thread deals orders out to the
+  deques round-robin, a worker takes orders from the front of its own deque
+  and, when it runs dry, steals from the back of another worker's deque.
+  A prepared order has its status set to 'C' and is pushed onto the
+  completed orders stack.
+
+  The kitchen works on demand: orders reach the workers only when drain()
+  hands them the whole OrderQueue, and the workers sleep in between. An
+  order stays pending until then, so it can still be displayed, deleted
+  or cancelled, and the OrderQueue and the completed stack are only ever
+  touched by one thread outside a drain. Pulling from the queue all the
+  time would take those pending states away and put a lock around every
+  read of either container.
+
+  Basic operations:
+    Constructor:       Starts the worker threads with a prepare callback.
+    Destructor:        Shuts the workers down gracefully.
+    drain:             Moves every pending order through the kitchen and
+                       waits until all of them are completed.
+    shutdown:          Finishes the orders in progress and stops the workers.
+    Statistics:        Per-worker counts of prepared and stolen orders, busy
+                       time and throughput.
+    Latency:           Histograms of the time orders spent waiting in the
+                       queue, in the kitchen and from creation to completion.
+
+  Class Invariant:
+    1. `queued` counts the orders sitting in the worker deques and
+       `inFlight` the orders handed to the kitchen but not yet completed.
+    2. Only one thread calls drain() at a time; it is the only thread that
+       touches the OrderQueue while the kitchen works.
+    3. Workers push onto the completed stack one at a time, under
+       `completedLock`.
+    4. Every completed order is stamped COMPLETED and its waits recorded
+       in the latency histograms, which workers update without locks.
+-----------------------------------------------------------------------------*/
+
+#ifndef KITCHENEXECUTOR_H
+#define KITCHENEXECUTOR_H
+
+#include "OrderQueue.h"
+#include "CompletedOrderStack.h"
+#include "LatencyHistogram.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class KitchenExecutor {
+public:
+    typedef function<void(Order&)> PrepareFunction;
+
+    /***** Worker Statistics *****/
+    struct WorkerStats {
+        long long ordersPrepared;  // Orders this worker completed
+        long long ordersStolen;    // Orders taken from other workers' deques
+        double busySeconds;        // Time spent preparing and completing orders
+    };
+
+    /***** Constructor and Destructor *****/
+    KitchenExecutor(int workers = 0, PrepareFunction prepare = PrepareFunction());
+    /*------------------------------------------------------------------------
+      Construct a kitchen and start its worker threads.
+
+      Precondition:  prepare, if given, may be called from several threads
+                     at once on different orders.
+      Postcondition: workers threads are waiting for orders; 0 starts one
+                     per hardware thread. Every order is passed to prepare
+                     before it is completed.
+    ------------------------------------------------------------------------*/
+
+    ~KitchenExecutor();
+    /*------------------------------------------------------------------------
+      Destructor: Shuts the kitchen down.
+
+      Precondition:  No drain() is running.
+      Postcondition: All worker threads have been joined.
+    ------------------------------------------------------------------------*/
+
+    /***** Kitchen Operations *****/
+    int drain(OrderQueue& queue, CompletedOrderStack& completed);
+    /*------------------------------------------------------------------------
+      Prepare every pending order in the queue.
+
+      Precondition:  The kitchen has not been shut down. No other thread
+                     uses queue or completed until drain() returns.
+      Postcondition: queue is empty and each of its orders was prepared,
+                     marked 'C' and pushed onto completed, in the order the
+                     workers finished them. Returns the number of orders.
+    ------------------------------------------------------------------------*/
+
+    void shutdown();
+    /*------------------------------------------------------------------------
+      Stop the kitchen gracefully.
+
+      Precondition:  None.
+      Postcondition: Orders already in the worker deques are completed, the
+                     workers exit and are joined. Later calls do nothing.
+    ------------------------------------------------------------------------*/
+
+    /***** Statistics *****/
+    int getWorkerCount() const;
+    /*------------------------------------------------------------------------
+      Retrieve the number of worker threads.
+
+      Precondition:  None.
+      Postcondition: Returns the number of workers started.
+    ------------------------------------------------------------------------*/
+
+    WorkerStats getWorkerStats(int worker) const;
+    /*------------------------------------------------------------------------
+      Retrieve the statistics of one worker since the kitchen started.
+
+      Precondition:  0 <= worker < getWorkerCount().
+      Postcondition: Returns the worker's counters and busy time.
+    ------------------------------------------------------------------------*/
+
+    void printStats(ostream& out) const;
+    /*------------------------------------------------------------------------
+      Output a table of per-worker statistics.
+
+      Precondition:  ostream out is open.
+      Postcondition: Outputs, for each worker, the orders prepared and
+                     stolen, the busy time and the orders per busy second.
+    ------------------------------------------------------------------------*/
+
+    const LatencyHistogram& getQueueWait() const;
+    const LatencyHistogram& getKitchenTime() const;
+    const LatencyHistogram& getTimeToComplete() const;
+    /*------------------------------------------------------------------------
+      Retrieve the latency histograms of the orders completed so far:
+      enqueued to dequeued, dequeued to completed, and created to
+      completed.
+
+      Precondition:  None.
+      Postcondition: Returns the histogram, which keeps being updated.
+    ------------------------------------------------------------------------*/
+
+    void printLatency(ostream& out) const;
+    /*------------------------------------------------------------------------
+      Output the latency histograms.
+
+      Precondition:  ostream out is open.
+      Postcondition: Outputs one line of percentiles per histogram.
+    ------------------------------------------------------------------------*/
+
+private:
+    /***** Per-Worker State *****/
+    struct Worker {
+        mutable mutex lock;      // Guards orders and stats
+        deque<Order> orders;     // Orders dealt to this worker
+        WorkerStats stats;       // Counters reported by getWorkerStats()
+        thread handle;           // The worker thread
+    };
+
+    PrepareFunction prepare;        // Callback run on every order
+    vector<Worker*> workers;        // One entry per worker thread
+
+    mutex wakeLock;                 // Guards sleeping and waking workers
+    condition_variable wake;        // Signalled when orders arrive or on shutdown
+    atomic<int> queued;             // Orders waiting in the worker deques
+    bool stopping;                  // Set by shutdown(), guarded by wakeLock
+
+    mutex doneLock;                 // Guards waiting for a drain to finish
+    condition_variable done;        // Signalled when inFlight drops to zero
+    atomic<int> inFlight;           // Orders handed out and not yet completed
+
+    mutex completedLock;            // Serializes pushes onto the stack
+    CompletedOrderStack* completed; // Destination of the current drain
+
+    LatencyHistogram queueWait;     // Enqueued to dequeued
+    LatencyHistogram kitchenTime;   // Dequeued to completed
+    LatencyHistogram timeToComplete;// Created to completed
+
+    void run(int self);
+    /*------------------------------------------------------------------------
+      Body of worker thread self.
+
+      Precondition:  0 <= self < workers.size().
+      Postcondition: Prepares orders from its own deque, then stolen ones,
+                     sleeping while there are none, until shutdown.
+    ------------------------------------------------------------------------*/
+
+    bool takeOrder(int self, Order& order);
+    /*------------------------------------------------------------------------
+      Take the next order for worker self.
+
+      Precondition:  0 <= self < workers.size().
+      Postcondition: Returns true and moves into order the front order of
+                     self's deque or, failing that, the back order of
+                     another worker's deque. Returns false if all deques
+                     are empty.
+    ------------------------------------------------------------------------*/
+
+    KitchenExecutor(const KitchenExecutor& other) = delete;
+    KitchenExecutor& operator=(const KitchenExecutor& other) = delete;
+};
+
+#endif // KITCHENEXECUTOR_H
@@ -0,0 +1,148 @@
+/*-- LatencyHistogram.cpp ----------------------------------------------------
+              This file implements LatencyHistogram member functions.
+--------------------------------------------------------------------------*/
+
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iomanip>
+
+// Position of the highest set bit of a non-zero value
+static int highestBit(unsigned long long value){
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1)
+        bit++;
+    return bit;
+#endif
+}
+
+//--- Definition of LatencyHistogram constructor
+LatencyHistogram::LatencyHistogram(){
+    for (int i = 0; i < BUCKETS; i++) {
+        counts[i].store(0, memory_order_relaxed);
+    }
+    total.store(0);
+    sum.store(0);
+    smallest.store(LLONG_MAX);
+    largest.store(0);
+}
+
+//--- Definition of bucketIndex()
+int LatencyHistogram::bucketIndex(unsigned long long value){
+    if (value < (1ULL << SUB_BITS))
+        return (int)value; // One bucket per value
+
+    // Keep the SUB_BITS highest bits: the power of two picks the group,
+    // the bits below the highest one the bucket within it
+    int shift = highestBit(value) - (SUB_BITS - 1);
+    return (shift << (SUB_BITS - 1)) + (int)(value >> shift);
+}
+
+//--- Definition of bucketHighest()
+long long LatencyHistogram::bucketHighest(int index){
+    if (index < (1 << SUB_BITS))
+        return index;
+
+    int shift = (index >> (SUB_BITS - 1)) - 1;
+    unsigned long long mantissa = index - (shift << (SUB_BITS - 1));
+    unsigned long long highest = ((mantissa + 1) << shift) - 1;
+    return highest > (unsigned long long)LLONG_MAX ? LLONG_MAX : (long long)highest;
+}
+
+//--- Definition of record()
+void LatencyHistogram::record(long long nanoseconds){
+    if (nanoseconds < 0)
+        nanoseconds = 0;
+
+    // Counters only need to be atomic, not ordered with each other
+    counts[bucketIndex(nanoseconds)].fetch_add(1, memory_order_relaxed);
+    total.fetch_add(1, memory_order_relaxed);
+    sum.fetch_add(nanoseconds, memory_order_relaxed);
+
+    long long seen = smallest.load(memory_order_relaxed);
+    while (nanoseconds < seen
+           && !smallest.compare_exchange_weak(seen, nanoseconds, memory_order_relaxed)) {
+    }
+    seen = largest.load(memory_order_relaxed);
+    while (nanoseconds > seen
+           && !largest.compare_exchange_weak(seen, nanoseconds, memory_order_relaxed)) {
+    }
+}
+
+//--- Definition of reset()
+void LatencyHistogram::reset(){
+    for (int i = 0; i < BUCKETS; i++) {
+        counts[i].store(0, memory_order_relaxed);
+    }
+    total.store(0);
+    sum.store(0);
+    smallest.store(LLONG_MAX);
+    largest.store(0);
+}
+
+//--- Definition of getCount()
+long long LatencyHistogram::getCount() const {
+    return total.load(memory_order_relaxed);
+}
+
+//--- Definition of getMean()
+double LatencyHistogram::getMean() const {
+    long long count = getCount();
+    return count > 0 ? (double)sum.load(memory_order_relaxed) / count : 0;
+}
+
+//--- Definition of getMin()
+long long LatencyHistogram::getMin() const {
+    return getCount() > 0 ? smallest.load(memory_order_relaxed) : 0;
+}
+
+//--- Definition of getMax()
+long long LatencyHistogram::getMax() const {
+    return largest.load(memory_order_relaxed);
+}
+
+//--- Definition of percentile()
+long long LatencyHistogram::percentile(double fraction) const {
+    long long count = getCount();
+    if (count == 0)
+        return 0;
+
+    // Rank of the value asked for, 1-based
+    long long rank = (long long)ceil(fraction * count);
+    if (rank < 1)
+        rank = 1;
+
+    long long seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += counts[i].load(memory_order_relaxed);
+        if (seen >= rank)
+            return min(bucketHighest(i), getMax());
+    }
+    return getMax(); // Counts changed while walking
+}
+
+//--- Definition of printHeader()
+void LatencyHistogram::printHeader(ostream& out){
+    out << left << setw(16) << "Latency" << right << setw(10) << "Count"
+        << setw(12) << "mean (us)" << setw(12) << "p50 (us)" << setw(12) << "p90 (us)"
+        << setw(12) << "p99 (us)" << setw(12) << "p99.9 (us)" << setw(12) << "max (us)"
+        << endl;
+}
+
+//--- Definition of print()
+void LatencyHistogram::print(ostream& out, const string& name) const {
+    out << left << setw(16) << name << right << setw(10) << getCount()
+        << fixed << setprecision(2)
+        << setw(12) << getMean() / 1000.0
+        << setw(12) << percentile(0.50) / 1000.0
+        << setw(12) << percentile(0.90) / 1000.0
+        << setw(12) << percentile(0.99) / 1000.0
+        << setw(12) << percentile(0.999) / 1000.0
+        << setw(12) << getMax() / 1000.0 << endl;
+    out.unsetf(ios::fixed);
+    out << setprecision(6);
+}
@@ -0,0 +1,131 @@
+/*-- LatencyHistogram.h ------------------------------------------------------
+
+  This header file defines the LatencyHistogram class, a fixed-size
+  histogram of durations in nanoseconds in the style of HdrHistogram.
+  Values are grouped into buckets whose width grows with the value: below
+  2^SUB_BITS every value has its own bucket, and above that each power of
+  two is split into 2^(SUB_BITS - 1) equal buckets. Any recorded value is
+  therefore reported within 1 / 2^(SUB_BITS - 1) (under 2%) of its true
+  value, from nanoseconds to hours, in a few KB of counters.
+
+  Recording is one count-leading-zeros, a shift and an atomic increment,
+  without locks, so kitchen workers can record concurrently at negligible
+  cost. Percentiles are read by walking the buckets.
+
+  Basic operations:
+    Constructor:       Creates an empty histogram.
+    record:            Adds one duration.
+    reset:             Removes every duration.
+    Accessors:         Count, mean, minimum and maximum.
+    percentile:        Returns the duration below which a fraction falls.
+    print:             Outputs count, mean, p50, p90, p99, p99.9 and max.
+
+  Class Invariant:
+    1. counts[i] is the number of recorded values v with
+       bucketIndex(v) == i; `total` is the sum of the counts.
+    2. `sum`, `smallest` and `largest` cover the same values.
+    3. Every member is atomic: record() may run on any number of threads
+       while the histogram is read, which sees a recent, not necessarily
+       consistent, state.
+-----------------------------------------------------------------------------*/
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 7;  // Buckets per power of two: 2^(SUB_BITS - 1)
+    static const int BUCKETS = (64 - SUB_BITS + 2) << (SUB_BITS - 1);
+
+    /***** Constructor *****/
+    LatencyHistogram();
+    /*------------------------------------------------------------------------
+      Construct an empty histogram.
+
+      Precondition:  None.
+      Postcondition: getCount() is 0.
+    ------------------------------------------------------------------------*/
+
+    /***** Recording *****/
+    void record(long long nanoseconds);
+    /*------------------------------------------------------------------------
+      Add one duration.
+
+      Precondition:  None. Negative durations (clock misuse) count as 0.
+      Postcondition: The duration is counted; safe to call concurrently.
+    ------------------------------------------------------------------------*/
+
+    void reset();
+    /*------------------------------------------------------------------------
+      Remove every duration.
+
+      Precondition:  No thread is recording.
+      Postcondition: getCount() is 0.
+    ------------------------------------------------------------------------*/
+
+    /***** Accessors *****/
+    long long getCount() const;
+    double getMean() const;
+    long long getMin() const;
+    long long getMax() const;
+    /*------------------------------------------------------------------------
+      Retrieve summary values of the durations recorded.
+
+      Precondition:  None.
+      Postcondition: Returns them in nanoseconds; 0 with no durations.
+    ------------------------------------------------------------------------*/
+
+    long long percentile(double fraction) const;
+    /*------------------------------------------------------------------------
+      Retrieve a percentile.
+
+      Precondition:  0 <= fraction <= 1 (0.99 for p99).
+      Postcondition: Returns the highest value of the bucket holding the
+                     value at that rank, capped at getMax(); 0 with no
+                     durations.
+    ------------------------------------------------------------------------*/
+
+    void print(ostream& out, const string& name) const;
+    /*------------------------------------------------------------------------
+      Output one line of statistics.
+
+      Precondition:  ostream out is open.
+      Postcondition: Outputs name, the count, and the mean, p50, p90, p99,
+                     p99.9 and maximum in microseconds.
+    ------------------------------------------------------------------------*/
+
+    static void printHeader(ostream& out);
+    /*------------------------------------------------------------------------
+      Output the column titles of print().
+
+      Precondition:  ostream out is open.
+      Postcondition: Outputs one line of titles.
+    ------------------------------------------------------------------------*/
+
+private:
+    atomic<long long> counts[BUCKETS];
+    atomic<long long> total;
+    atomic<long long> sum;
+    atomic<long long> smallest;
+    atomic<long long> largest;
+
+    static int bucketIndex(unsigned long long value);
+    static long long bucketHighest(int index);
+    /*------------------------------------------------------------------------
+      Map a value to its bucket, and a bucket to its highest value.
+
+      Precondition:  0 <= index < BUCKETS.
+      Postcondition: bucketHighest(bucketIndex(v)) >= v, within 2%.
+    ------------------------------------------------------------------------*/
+
+    LatencyHistogram(const LatencyHistogram& other) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram& other) = delete;
+};
+
+#endif // LATENCYHISTOGRAM_H
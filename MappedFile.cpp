@@ -0,0 +1,111 @@
+/*-- MappedFile.cpp ----------------------------------------------------------
+              This file implements MappedFile member functions.
+--------------------------------------------------------------------------*/
+
+#include "MappedFile.h"
+#include "Metrics.h"
+#include <fstream>
+#include <iostream>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPEDFILE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//--- Definition of MappedFile constructor
+MappedFile::MappedFile() : contents(NULL), length(0), mapped(false) {
+}
+
+//--- Definition of MappedFile destructor
+MappedFile::~MappedFile(){
+    close();
+}
+
+//--- Definition of open()
+bool MappedFile::open(const string& filename){
+    close();
+
+#ifdef MAPPEDFILE_MMAP
+    int descriptor = ::open(filename.c_str(), O_RDONLY);
+    if(descriptor < 0)
+        return false;
+
+    struct stat info;
+    if(fstat(descriptor, &info) != 0){
+        ::close(descriptor);
+        return false;
+    }
+
+    if(info.st_size > 0){
+        void* address = mmap(NULL, (size_t)info.st_size, PROT_READ,
+                             MAP_PRIVATE, descriptor, 0);
+        if(address != MAP_FAILED){
+            // Files are scanned front to back: read ahead aggressively
+            madvise(address, (size_t)info.st_size, MADV_SEQUENTIAL);
+            contents = (const char*)address;
+            length = (size_t)info.st_size;
+            mapped = true;
+            ::close(descriptor); // The mapping stays valid
+            return true;
+        }
+    }
+    ::close(descriptor);
+    // Empty files cannot be mapped; special files may refuse. Read them.
+#endif
+
+    ifstream file(filename, ios::binary | ios::ate);
+    if(!file.is_open())
+        return false;
+
+    streamoff bytes = file.tellg();
+    if(bytes <= 0)
+        return bytes == 0;
+
+    char* buffer = new(nothrow) char[(size_t)bytes];
+    if(!buffer){
+        METRIC_INC(ALLOCATION_FAILURES);
+        cerr << "Memory Allocation Failed" << endl;
+        return false;
+    }
+
+    file.seekg(0);
+    if(!file.read(buffer, bytes)){
+        delete [] buffer;
+        return false;
+    }
+
+    contents = buffer;
+    length = (size_t)bytes;
+    mapped = false;
+    return true;
+}
+
+//--- Definition of close()
+void MappedFile::close(){
+    if(contents){
+#ifdef MAPPEDFILE_MMAP
+        if(mapped)
+            munmap((void*)contents, length);
+        else
+#endif
+            delete [] contents;
+    }
+
+    contents = NULL;
+    length = 0;
+    mapped = false;
+}
+
+//--- Definition of data()
+const char* MappedFile::data() const {
+    return contents;
+}
+
+//--- Definition of size()
+size_t MappedFile::size() const {
+    return length;
+}
@@ -0,0 +1,97 @@
+/*-- MappedFile.h ------------------------------------------------------------
+
+  This header file defines the MappedFile class, a read-only view of a
+  whole file in memory. On POSIX systems the file is mapped with mmap, so
+  its pages are read on demand straight from the page cache without being
+  copied; elsewhere the file is read into a buffer once. Either way the
+  contents can be scanned in place, for example with string_view.
+
+  Basic operations:
+    Constructor:       Creates a MappedFile with no file open.
+    Destructor:        Unmaps or frees the contents.
+    open:              Maps a file, replacing any file already open.
+    close:             Releases the file.
+    data / size:       Access the contents.
+
+  Class Invariant:
+    1. data() points to size() readable bytes, or is NULL when size() is 0.
+    2. The contents are not NUL-terminated and must not be modified.
+    3. `mapped` tells whether the contents came from mmap (and are released
+       with munmap) or from the heap (and are released with delete []).
+-----------------------------------------------------------------------------*/
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+class MappedFile {
+public:
+    /***** Constructor and Destructor *****/
+    MappedFile();
+    /*------------------------------------------------------------------------
+      Construct a MappedFile with no file open.
+
+      Precondition:  None.
+      Postcondition: data() is NULL and size() is 0.
+    ------------------------------------------------------------------------*/
+
+    ~MappedFile();
+    /*------------------------------------------------------------------------
+      Destructor: Releases the contents of the open file.
+
+      Precondition:  None.
+      Postcondition: Pointers obtained from data() are no longer valid.
+    ------------------------------------------------------------------------*/
+
+    /***** File Operations *****/
+    bool open(const string& filename);
+    /*------------------------------------------------------------------------
+      Make the contents of a file available in memory.
+
+      Precondition:  None.
+      Postcondition: Returns true and exposes the whole file through data()
+                     and size() if it could be opened and read; otherwise
+                     returns false with no file open. An empty file opens
+                     with a size of 0.
+    ------------------------------------------------------------------------*/
+
+    void close();
+    /*------------------------------------------------------------------------
+      Release the open file, if any.
+
+      Precondition:  None.
+      Postcondition: data() is NULL and size() is 0.
+    ------------------------------------------------------------------------*/
+
+    /***** Accessors *****/
+    const char* data() const;
+    /*------------------------------------------------------------------------
+      Retrieve the contents of the file.
+
+      Precondition:  None.
+      Postcondition: Returns a pointer to the first byte, or NULL if no
+                     bytes are available.
+    ------------------------------------------------------------------------*/
+
+    size_t size() const;
+    /*------------------------------------------------------------------------
+      Retrieve the size of the file.
+
+      Precondition:  None.
+      Postcondition: Returns the number of bytes available from data().
+    ------------------------------------------------------------------------*/
+
+private:
+    const char* contents;  // First byte of the file
+    size_t length;         // Number of bytes
+    bool mapped;           // true if contents must be released with munmap
+
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+};
+
+#endif // MAPPEDFILE_H
@@ -3,71 +3,471 @@
 --------------------------------------------------------------------------*/
 
 #include "Menu.h"
+#include "MappedFile.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#if defined(__GNUC__)
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address) ((void)0)
+#endif
+
+// Binary snapshot layout, documented with Menu::saveSnapshot()
+static const char SNAPSHOT_MAGIC[8] = {'R', 'M', 'S', 'M', 'E', 'N', 'U', '\0'};
+static const uint32_t SNAPSHOT_VERSION = 1;
+static const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t count;
+    int32_t lastId;
+    uint32_t stringBytes;
+    uint32_t checksum;
+};
+
+struct Menu::SnapshotEntry {
+    int32_t id;
+    uint32_t padding;
+    int64_t cents;
+    uint32_t nameOffset;
+    uint32_t descriptionOffset;
+};
+
+static_assert(sizeof(SnapshotHeader) == 32, "snapshot header must be 32 bytes");
+
+// FNV-1a over 32-bit words, with the trailing bytes folded in one by one
+static uint32_t snapshotChecksum(const char* data, size_t length){
+    uint32_t hash = 2166136261u;
+    size_t i = 0;
+    for(; i + 4 <= length; i += 4){
+        uint32_t word;
+        memcpy(&word, data + i, 4);
+        hash = (hash ^ word) * 16777619u;
+    }
+    for(; i < length; i++){
+        hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+    }
+    return hash;
+}
 
 //--- Definition of Menu constructor
 Menu::Menu(int capacity){
+    if(capacity < 1)
+        capacity = 1;
+
     size = 0;
+    lastId = 0;
     this->capacity = capacity;
-    array = new MenuItem[capacity];
+    ids = new int[capacity];
+    prices = new Money[capacity];
+    texts = new MenuText[capacity];
+
+    idIndex = NULL;
+    indexCapacity = 0;
+
+    image = NULL;
+    imageItems = NULL;
+    imageStrings = NULL;
+    imageSize = 0;
+    imageStringBytes = 0;
+    imageText = NULL;
+    searchIndexed = true;
+
+    // Keep the index at most half full
+    int buckets = 1;
+    while(buckets < 2 * capacity)
+        buckets *= 2;
+    rebuildIndex(buckets);
 }
 
 //--- Definition of Menu destructor
 Menu::~Menu(){
-    delete [] array; // Free the memory
+    delete [] ids; // Free the memory
+    delete [] prices;
+    delete [] texts;
+    delete [] idIndex;
+    delete image;
+    delete [] imageText;
+}
+
+//--- Definition of Menu move constructor
+Menu::Menu(Menu&& other) noexcept
+    : ids(other.ids), prices(other.prices), texts(other.texts),
+      capacity(other.capacity), size(other.size), lastId(other.lastId),
+      idIndex(other.idIndex), indexCapacity(other.indexCapacity),
+      image(other.image), imageItems(other.imageItems),
+      imageStrings(other.imageStrings), imageSize(other.imageSize),
+      imageStringBytes(other.imageStringBytes), imageText(other.imageText),
+      searchIndex(move(other.searchIndex)), searchIndexed(other.searchIndexed) {
+    // Leave other empty so its destructor does not free the storage
+    other.ids = NULL;
+    other.prices = NULL;
+    other.texts = NULL;
+    other.capacity = 0;
+    other.size = 0;
+    other.lastId = 0;
+    other.idIndex = NULL;
+    other.indexCapacity = 0;
+    other.image = NULL;
+    other.imageSize = 0;
+    other.imageText = NULL;
+    other.searchIndex.clear();
+    other.searchIndexed = true;
+}
+
+//--- Definition of move assignment operator=()
+Menu& Menu::operator=(Menu&& other) noexcept {
+    if(this != &other){ // Avoid self-assignment
+        // Free existing resources
+        delete [] ids;
+        delete [] prices;
+        delete [] texts;
+        delete [] idIndex;
+        delete image;
+        delete [] imageText;
+
+        // Take over the storage of the other object
+        ids = other.ids;
+        prices = other.prices;
+        texts = other.texts;
+        capacity = other.capacity;
+        size = other.size;
+        lastId = other.lastId;
+        idIndex = other.idIndex;
+        indexCapacity = other.indexCapacity;
+        image = other.image;
+        imageItems = other.imageItems;
+        imageStrings = other.imageStrings;
+        imageSize = other.imageSize;
+        imageStringBytes = other.imageStringBytes;
+        imageText = other.imageText;
+        searchIndex = move(other.searchIndex);
+        searchIndexed = other.searchIndexed;
+
+        other.ids = NULL;
+        other.prices = NULL;
+        other.texts = NULL;
+        other.capacity = 0;
+        other.size = 0;
+        other.lastId = 0;
+        other.idIndex = NULL;
+        other.indexCapacity = 0;
+        other.image = NULL;
+        other.imageSize = 0;
+        other.imageText = NULL;
+        other.searchIndex.clear();
+        other.searchIndexed = true;
+    }
+
+    return *this;
 }
 
 //--- Definition of resize()
 void Menu::resize(){
-    // Allocate new memory and copy items
-    MenuItem* newArray = new MenuItem[capacity*2];
+    reserve(capacity > 0 ? capacity * 2 : 10);
+}
+
+//--- Definition of reserve()
+void Menu::reserve(int newCapacity){
+    TRACE_SPAN("Menu::reserve");
+    materialize();
+    if(newCapacity <= capacity)
+        return;
+
+    METRIC_INC(MENU_RESIZES);
+
+    // Allocate new memory and copy each column
+    int* newIds = new int[newCapacity];
+    Money* newPrices = new Money[newCapacity];
+    MenuText* newTexts = new MenuText[newCapacity];
+    copy(ids, ids + size, newIds);
+    copy(prices, prices + size, newPrices);
+    copy(texts, texts + size, newTexts);
+
+    capacity = newCapacity;
+    delete [] ids;
+    delete [] prices;
+    delete [] texts;
+    ids = newIds;
+    prices = newPrices;
+    texts = newTexts;
+
+    if(searchIndexed)
+        searchIndex.reserve(newCapacity);
+
+    // Items keep their positions, only the index needs more buckets
+    if(indexCapacity < 2 * capacity){
+        int buckets = indexCapacity > 0 ? indexCapacity : 1;
+        while(buckets < 2 * capacity)
+            buckets *= 2;
+        rebuildIndex(buckets);
+    }
+}
+
+//--- Definition of homeBucket()
+int Menu::homeBucket(int id) const {
+    // Multiplicative hashing spreads consecutive IDs across the table
+    unsigned int hash = (unsigned int)id * 2654435769u;
+    hash ^= hash >> 16;
+
+    return (int)(hash & (unsigned int)(indexCapacity - 1));
+}
+
+//--- Definition of bucketFor()
+int Menu::bucketFor(int id) const {
+    int mask = indexCapacity - 1;
+    int bucket = homeBucket(id);
+
+    // Linear probing: stop at the ID or at the first unused bucket
+    while(idIndex[bucket].id != EMPTY_SLOT && idIndex[bucket].id != id){
+        bucket = (bucket + 1) & mask;
+    }
+
+    return bucket;
+}
+
+//--- Definition of findSlot()
+int Menu::findSlot(int id) const {
+    if(indexCapacity == 0)
+        return -1; // Moved-from Menu has no index
+
+    int bucket = bucketFor(id);
+    if(idIndex[bucket].id == EMPTY_SLOT)
+        return -1;
+
+    return idIndex[bucket].slot;
+}
+
+//--- Definition of indexInsert()
+void Menu::indexInsert(int id, int slot){
+    int bucket = bucketFor(id);
+    idIndex[bucket].id = id;
+    idIndex[bucket].slot = slot;
+}
+
+//--- Definition of indexErase()
+void Menu::indexErase(int id){
+    if(indexCapacity == 0)
+        return;
+
+    int bucket = bucketFor(id);
+    if(idIndex[bucket].id == EMPTY_SLOT)
+        return; // Not indexed
+
+    int mask = indexCapacity - 1;
+    int hole = bucket;
+    int next = (hole + 1) & mask;
+
+    // Shift back every entry of the probe run that would no longer be
+    // reachable once the hole is opened (backward-shift deletion)
+    while(idIndex[next].id != EMPTY_SLOT){
+        int home = homeBucket(idIndex[next].id);
+
+        // Distance travelled from home to next, and from home to the hole
+        int toNext = (next - home) & mask;
+        int toHole = (hole - home) & mask;
+        if(toHole < toNext){
+            idIndex[hole] = idIndex[next];
+            hole = next;
+        }
+
+        next = (next + 1) & mask;
+    }
+
+    idIndex[hole].id = EMPTY_SLOT;
+}
+
+//--- Definition of rebuildIndex()
+void Menu::rebuildIndex(int buckets){
+    delete [] idIndex;
+
+    METRIC_INC(MENU_INDEX_REBUILDS);
+    indexCapacity = buckets;
+    idIndex = new IndexBucket[indexCapacity];
+    for(int i = 0; i < indexCapacity; i++){
+        idIndex[i].id = EMPTY_SLOT;
+    }
+
+    // Only the ID column is read
     for(int i = 0; i < size; i++){
-        newArray[i] = array[i]; // Copy each item
+        indexInsert(ids[i], i);
     }
-    
-    capacity *= 2;
-    delete [] array;
-    array = newArray;
 }
 
 //--- Definition of getItemById()
-MenuItem Menu::getItemById(int id) {
-    for(int i = 0; i < size; i++){
-        if(id == array[i].getId()){
-            return array[i]; // Return the item
+MenuItem Menu::getItemById(int id) const {
+    METRIC_INC(MENU_LOOKUPS);
+    if(image){
+        int entry = findImageEntry(id); // Served from the snapshot
+        if(entry != -1)
+            return imageItem(entry);
+        METRIC_INC(MENU_LOOKUP_MISSES);
+        return MenuItem(-1, "", "", Money(99));
+    }
+
+    int slot = findSlot(id);
+    if(slot != -1){ // The ID is known, its column need not be read
+        return MenuItem(id, texts[slot].name, texts[slot].description, prices[slot]);
+    }
+
+    METRIC_INC(MENU_LOOKUP_MISSES);
+    return MenuItem(-1, "", "", Money(99)); // Return MenuItem with ID of -1
+}
+
+//--- Definition of getPrice()
+bool Menu::getPrice(int id, Money& price) const {
+    METRIC_INC(MENU_LOOKUPS);
+    if(image){
+        int entry = findImageEntry(id); // No text to intern
+        if(entry != -1){
+            price = Money(imageItems[entry].cents);
+            return true;
         }
+    } else {
+        int slot = findSlot(id);
+        if(slot != -1){
+            price = prices[slot];
+            return true;
+        }
+    }
+
+    METRIC_INC(MENU_LOOKUP_MISSES);
+    return false;
+}
+
+//--- Definition of getPrices()
+int Menu::getPrices(const vector<int>& itemIds, vector<Money>& found) const {
+    size_t count = itemIds.size();
+    found.assign(count, Money());
+    METRIC_ADD(MENU_LOOKUPS, (long long)count);
+
+    int hits = 0;
+    if(image){
+        for(size_t i = 0; i < count; i++){
+            int entry = findImageEntry(itemIds[i]);
+            if(entry != -1){
+                found[i] = Money(imageItems[entry].cents);
+                hits++;
+            }
+        }
+    } else if(indexCapacity > 0){
+        // A batch at a time: request every bucket of the batch, then every
+        // price, so their cache misses overlap instead of queueing
+        const size_t BATCH = 16;
+        int slots[BATCH];
+        for(size_t first = 0; first < count; first += BATCH){
+            size_t last = min(count, first + BATCH);
+            for(size_t i = first; i < last; i++){
+                PREFETCH(&idIndex[homeBucket(itemIds[i])]);
+            }
+            for(size_t i = first; i < last; i++){
+                slots[i - first] = findSlot(itemIds[i]);
+                if(slots[i - first] != -1)
+                    PREFETCH(&prices[slots[i - first]]);
+            }
+            for(size_t i = first; i < last; i++){
+                if(slots[i - first] != -1){
+                    found[i] = prices[slots[i - first]];
+                    hits++;
+                }
+            }
+        }
+    }
+
+    METRIC_ADD(MENU_LOOKUP_MISSES, (long long)count - hits);
+    return hits;
+}
+
+//--- Definition of search()
+vector<MenuItem> Menu::search(const string& query, int limit) const {
+    TRACE_SPAN("Menu::search");
+    if(!searchIndexed){
+        int count = image ? imageSize : size;
+        for(int i = 0; i < count; i++){
+            MenuItem item = image ? imageItem(i) : itemAt(i);
+            searchIndex.add(item.getId(), item.getName(), item.getDescription());
+        }
+        searchIndexed = true;
     }
 
-    return MenuItem(-1, "", "", 0.99); // Return MenuItem with ID of -1
+    vector<int> ids = searchIndex.search(query, limit);
+    vector<MenuItem> items;
+    items.reserve(ids.size());
+    for(size_t i = 0; i < ids.size(); i++){
+        items.push_back(getItemById(ids[i]));
+    }
+    return items;
 }
 
 //--- Definition of addItem()
 void Menu::addItem(const MenuItem& item){
-    if(size == capacity) // if array is full we double the capacity
+    addItem(MenuItem(item));
+}
+
+//--- Definition of addItem() taking a temporary
+void Menu::addItem(MenuItem&& item){
+    TRACE_SPAN("Menu::addItem");
+    int id = item.getId();
+    if(id < 1){ // EMPTY_SLOT and the "not found" ID -1 must never be indexed
+        cerr << "Error: Item ID " << id << " is not a positive integer" << endl;
+        return;
+    }
+
+    materialize();
+    if(searchIndexed)
+        searchIndex.add(id, item.getName(), item.getDescription());
+
+    // IDs are unique: replace an item that already uses this ID
+    int slot = findSlot(id);
+    if(slot != -1){
+        setSlot(slot, item);
+        return;
+    }
+
+    if(size == capacity) // if the arrays are full we double the capacity
         resize();
     
-    array[size] = item;
+    setSlot(size, item);
+    indexInsert(id, size);
     size++;
+
+    if(id > lastId)
+        lastId = id;
 }
 
 //--- Definition of deleteItem()
 bool Menu::deleteItem(int id){
-    int index = -1;
-    
-    // Search for item index
-    for(int i = 0; i < size; i++){
-        if(id == array[i].getId()){
-            index = i;
-            break;
-        }
-    }
+    TRACE_SPAN("Menu::deleteItem");
+    if(image && findImageEntry(id) == -1)
+        return false; // Nothing changes, keep serving from the snapshot
+    materialize();
+
+    int slot = findSlot(id);
     
     // If not found return false
-    if(index == -1)
+    if(slot == -1)
         return false;
     
-    // Shift elements
-    for(int i = index; i < size - 1; i++){
-        array[i] = array[ i + 1 ];
+    indexErase(id);
+    if(searchIndexed)
+        searchIndex.remove(id);
+
+    // Fill the hole with the last item instead of shifting every element
+    int last = size - 1;
+    if(slot != last){
+        ids[slot] = ids[last];
+        prices[slot] = prices[last];
+        texts[slot] = texts[last];
+        indexInsert(ids[slot], slot);
     }
     
     size--;
@@ -76,49 +476,104 @@ bool Menu::deleteItem(int id){
 
 //--- Definition of reset()
 void Menu::reset(){
-    delete [] array; // Free the memory
-    size = 0;
-    array = new MenuItem[capacity];
+    TRACE_SPAN("Menu::reset");
+    releaseImage();
+    size = 0; // The arrays hold no resources, only the count matters
+    lastId = 0;
+
+    for(int i = 0; i < indexCapacity; i++){
+        idIndex[i].id = EMPTY_SLOT;
+    }
+    searchIndex.clear();
+    searchIndexed = true;
 }
 
 //--- Definition of getLastItemId()
 int Menu::getLastItemId() const {
-    return array[size-1].getId();
+    return lastId;
 }
 
 //--- Definition of loadFromFile()
 void Menu::loadFromFile(const string& filename) {
-    ifstream file(filename);
+    TRACE_SPAN("Menu::loadFromFile");
+    MappedFile file;
     
-    if (!file.is_open()) {
+    if (!file.open(filename)) {
         cerr << "Error: Could not open file " << filename << endl;
         return;
     }
 
-    string line;
-    while (getline(file, line)) {
-        stringstream ss(line);
-        string idStr, name, description, priceStr;
+    const char* position = file.data();
+    const char* end = position + file.size();
+
+    // Indexing every item now would make loading several times slower;
+    // the first search indexes them all at once instead
+    searchIndex.clear();
+    searchIndexed = false;
+
+    // One pass to count the lines, so the array and index grow only once
+    int lines = 0;
+    for (const char* p = position; p < end; p++) {
+        p = (const char*)memchr(p, '\n', end - p);
+        if (p == NULL)
+            break;
+        lines++;
+    }
+    reserve(size + lines + 1);
+
+    int lineNumber = 0;
+    while (position < end) {
+        const char* newline = (const char*)memchr(position, '\n', end - position);
+        const char* lineEnd = newline ? newline : end;
+        string_view line(position, lineEnd - position);
+        position = newline ? newline + 1 : end;
+        lineNumber++;
 
-        // Split the line by commas
-        getline(ss, idStr, ',');   // Read id
-        getline(ss, name, ',');    // Read name
-        getline(ss, description, ','); // Read description
-        getline(ss, priceStr);    // Read price
+        if (!line.empty() && line.back() == '\r') // Windows line endings
+            line.remove_suffix(1);
+        if (line.find_first_not_of(" \t") == string_view::npos)
+            continue; // Blank line
 
-        int id = stoi(idStr); // Convert ID from string to integer
-        double price = stod(priceStr); // Convert price from string to double
+        // Split the line by commas: id, name, description, then the price
+        size_t nameStart = line.find(',');
+        size_t descriptionStart = nameStart == string_view::npos
+            ? nameStart : line.find(',', nameStart + 1);
+        size_t priceStart = descriptionStart == string_view::npos
+            ? descriptionStart : line.find(',', descriptionStart + 1);
+
+        const char* problem = NULL;
+        int id = 0;
+        Money price;
+        if (priceStart == string_view::npos) {
+            problem = "expected id,name,description,price";
+        } else {
+            from_chars_result parsed = from_chars(line.data(), line.data() + nameStart, id);
+            if (parsed.ec != errc() || parsed.ptr != line.data() + nameStart)
+                problem = "invalid item ID";
+            else if (id < 1)
+                problem = "item ID must be a positive integer";
+            else if (!Money::parse(line.data() + priceStart + 1,
+                                   line.data() + line.size(), price))
+                problem = "invalid price"; // Converted exactly to cents
+        }
+
+        if (problem) {
+            cerr << "Error: Skipping line " << lineNumber << " of " << filename
+                 << " (" << problem << "): " << line << endl;
+            continue;
+        }
 
         // Create a new MenuItem and add it to the menu
-        MenuItem item(id, name, description,price);
-        addItem(item);
+        string_view name = line.substr(nameStart + 1, descriptionStart - nameStart - 1);
+        string_view description = line.substr(descriptionStart + 1,
+                                              priceStart - descriptionStart - 1);
+        addItem(MenuItem(id, name, description, price)); // Interned in place
     }
-
-    file.close(); // Close the file
 }
 
 //--- Definition of saveToFile()
 void Menu::saveToFile(const string& filename) const {
+    TRACE_SPAN("Menu::saveToFile");
     ofstream file(filename);
     
     if (!file.is_open()) {
@@ -127,25 +582,257 @@ void Menu::saveToFile(const string& filename) const {
     }
 
     // Write all menu item details seperated by a comma
-    for(int i = 0; i < size; i++){
-        file << array[i].getId() << "," << array[i].getName() << ","
-                << array[i].getDescription() << "," 
-                << array[i].getPrice() << endl; // Write to the file
+    int count = image ? imageSize : size;
+    for(int i = 0; i < count; i++){
+        MenuItem item = image ? imageItem(i) : itemAt(i);
+        file << item.getId() << "," << item.getName() << ","
+                << item.getDescription() << "," 
+                << item.getPrice() << '\n'; // Write to the file
     }
     
     file.close(); // Close the file
 }
 
+//--- Definition of saveSnapshot()
+bool Menu::saveSnapshot(const string& filename) const {
+    TRACE_SPAN("Menu::saveSnapshot");
+    int count = image ? imageSize : size;
+
+    // Sort the items by ID so loaded snapshots can be binary searched
+    vector<MenuItem> items;
+    items.reserve(count);
+    for(int i = 0; i < count; i++){
+        items.push_back(image ? imageItem(i) : itemAt(i));
+    }
+    sort(items.begin(), items.end(), [](const MenuItem& a, const MenuItem& b){
+        return a.getId() < b.getId();
+    });
+
+    // Table and string blob, back to back as they are checksummed
+    size_t tableBytes = items.size() * sizeof(SnapshotEntry);
+    string body(tableBytes, '\0');
+    for(size_t i = 0; i < items.size(); i++){
+        SnapshotEntry entry;
+        entry.id = items[i].getId();
+        entry.padding = 0;
+        entry.cents = items[i].getPrice().getCents();
+        entry.nameOffset = (uint32_t)(body.size() - tableBytes);
+        body += items[i].getName();
+        entry.descriptionOffset = (uint32_t)(body.size() - tableBytes);
+        body += items[i].getDescription();
+        memcpy(&body[i * sizeof(SnapshotEntry)], &entry, sizeof(entry));
+    }
+
+    if(body.size() - tableBytes > UINT32_MAX){
+        cerr << "Error: Menu too large for a snapshot" << endl;
+        return false;
+    }
+
+    SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.count = (uint32_t)items.size();
+    header.lastId = lastId;
+    header.stringBytes = (uint32_t)(body.size() - tableBytes);
+    header.checksum = snapshotChecksum(body.data(), body.size());
+
+    ofstream file(filename, ios::binary);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open file " << filename << endl;
+        return false;
+    }
+
+    file.write((const char*)&header, sizeof(header));
+    file.write(body.data(), body.size());
+    file.close();
+
+    if(!file){
+        cerr << "Error: Could not write file " << filename << endl;
+        return false;
+    }
+    return true;
+}
+
+//--- Definition of loadSnapshot()
+bool Menu::loadSnapshot(const string& filename){
+    TRACE_SPAN("Menu::loadSnapshot");
+    MappedFile* file = new(nothrow) MappedFile();
+    if(!file){
+        METRIC_INC(ALLOCATION_FAILURES);
+        cerr << "Memory Allocation Failed" << endl;
+        return false;
+    }
+
+    if(!file->open(filename)){
+        cerr << "Error: Could not open file " << filename << endl;
+        delete file;
+        return false;
+    }
+
+    // Check the header and that the sizes add up before trusting the table
+    const char* problem = NULL;
+    SnapshotHeader header;
+    if(file->size() < sizeof(header)){
+        problem = "file too short";
+    } else {
+        memcpy(&header, file->data(), sizeof(header));
+        if(memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0)
+            problem = "not a menu snapshot";
+        else if(header.version != SNAPSHOT_VERSION)
+            problem = "unsupported version";
+        else if(header.byteOrder != SNAPSHOT_BYTE_ORDER)
+            problem = "written on a machine with another byte order";
+        else if(header.count > (uint32_t)INT32_MAX
+            || file->size() != sizeof(header)
+                + (size_t)header.count * sizeof(SnapshotEntry) + header.stringBytes)
+            problem = "truncated or wrong size";
+        else if(snapshotChecksum(file->data() + sizeof(header),
+                                 file->size() - sizeof(header)) != header.checksum)
+            problem = "checksum mismatch";
+    }
+
+    if(problem){
+        cerr << "Error: Invalid snapshot " << filename << " (" << problem << ")" << endl;
+        delete file;
+        return false;
+    }
+
+    // Drop the current items and serve lookups from the mapped table
+    reset();
+    image = file;
+    imageItems = (const SnapshotEntry*)(file->data() + sizeof(header));
+    imageStrings = file->data() + sizeof(header) + header.count * sizeof(SnapshotEntry);
+    imageSize = (int)header.count;
+    imageStringBytes = header.stringBytes;
+    imageText = new(nothrow) StringTable::Handle[2 * (size_t)imageSize]();
+    if(!imageText){ // Lookups still work, interning their text every time
+        METRIC_INC(ALLOCATION_FAILURES);
+        cerr << "Memory Allocation Failed" << endl;
+    }
+    lastId = header.lastId;
+    searchIndexed = false; // Indexed by the first search, not at every start
+    return true;
+}
+
+//--- Definition of isSnapshotFile()
+bool Menu::isSnapshotFile(const string& filename){
+    ifstream file(filename, ios::binary);
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+
+    return file.read(magic, sizeof(magic))
+        && memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+}
+
+//--- Definition of imageItem()
+MenuItem Menu::imageItem(int entry) const {
+    const SnapshotEntry& item = imageItems[entry];
+    StringTable::Handle* text = imageText ? imageText + 2 * (size_t)entry : NULL;
+    if(text && (text[0] != StringTable::EMPTY || text[1] != StringTable::EMPTY))
+        return MenuItem(item.id, text[0], text[1], Money(item.cents));
+
+    uint32_t nameEnd = item.descriptionOffset;
+    uint32_t descriptionEnd = entry + 1 < imageSize
+        ? imageItems[entry + 1].nameOffset : imageStringBytes;
+
+    // A damaged table must not send us outside the blob
+    string_view name, description;
+    if(item.nameOffset <= nameEnd && nameEnd <= descriptionEnd
+        && descriptionEnd <= imageStringBytes){
+        name = string_view(imageStrings + item.nameOffset, nameEnd - item.nameOffset);
+        description = string_view(imageStrings + nameEnd, descriptionEnd - nameEnd);
+    }
+
+    // Items without text are interned again each time, which is free
+    MenuItem created(item.id, name, description, Money(item.cents));
+    if(text){
+        text[0] = created.getNameHandle();
+        text[1] = created.getDescriptionHandle();
+    }
+    return created;
+}
+
+//--- Definition of itemAt()
+MenuItem Menu::itemAt(int slot) const {
+    return MenuItem(ids[slot], texts[slot].name, texts[slot].description, prices[slot]);
+}
+
+//--- Definition of setSlot()
+void Menu::setSlot(int slot, const MenuItem& item){
+    ids[slot] = item.getId();
+    prices[slot] = item.getPrice();
+    texts[slot].name = item.getNameHandle();
+    texts[slot].description = item.getDescriptionHandle();
+}
+
+//--- Definition of findImageEntry()
+int Menu::findImageEntry(int id) const {
+    int low = 0;
+    int high = imageSize - 1;
+
+    while(low <= high){
+        int middle = low + (high - low) / 2;
+        if(imageItems[middle].id < id)
+            low = middle + 1;
+        else if(imageItems[middle].id > id)
+            high = middle - 1;
+        else
+            return middle;
+    }
+
+    return -1;
+}
+
+//--- Definition of materialize()
+void Menu::materialize(){
+    if(!image)
+        return;
+
+    // Detach the image so reserve() and addItem() do not materialize again;
+    // the table stays mapped until every item has been copied
+    MappedFile* file = image;
+    image = NULL;
+    int savedLastId = lastId;
+    bool indexed = searchIndexed; // The items stay the same
+
+    searchIndexed = false;
+    reserve(imageSize + 1);
+    for(int i = 0; i < imageSize; i++){
+        addItem(imageItem(i));
+    }
+    lastId = savedLastId;
+    searchIndexed = indexed;
+
+    image = file;
+    releaseImage();
+}
+
+//--- Definition of releaseImage()
+void Menu::releaseImage(){
+    delete image;
+    image = NULL;
+    imageItems = NULL;
+    imageStrings = NULL;
+    imageSize = 0;
+    imageStringBytes = 0;
+    delete [] imageText;
+    imageText = NULL;
+}
+
 //--- Definition of overloaded operator<<()
 ostream& operator<<(ostream& out, const Menu& menu){
     out << "--- Menu Items ---" << endl;
 
-    if(menu.size == 0){
+    int count = menu.image ? menu.imageSize : menu.size;
+    if(count == 0){
         out << "No items on menu." << endl;
     }
 
-    for(int i = 0; i < menu.size; i++){
-        out << menu.array[i];
+    for(int i = 0; i < count; i++){
+        if(menu.image)
+            out << menu.imageItem(i);
+        else
+            out << menu.itemAt(i);
     }
 
     return out;
@@ -7,24 +7,61 @@
   Basic operations:
     Constructor:       Initializes the Menu with a default or specified capacity.
     Destructor:        Releases dynamically allocated memory.
+    Move operations:   Transfer the items and index to another Menu without
+                       copying them. Menus cannot be copied.
     Item management:   Add, delete, retrieve, and reset items in the Menu.
+    Prices:            Look up the price of one item or of many at once
+                       without reading the names.
+    Search:            Find items by the words of their names and
+                       descriptions (see MenuSearch.h).
+    Capacity:          Reserve room for a known number of items.
     File operations:   Load items from a file and save items to a file.
+    Snapshots:         Save the Menu as a binary image and load it back
+                       without parsing (see the format under saveSnapshot).
     Overloaded <<:     Outputs the entire Menu to an output stream.
 
+  Storage is split by how often a field is read. The item in slot i is
+  ids[i], prices[i] and texts[i]: the IDs and prices that lookups, price
+  totals and index rebuilds read are dense arrays of their own, and the
+  interned handles of the names and descriptions, needed only to show or
+  save an item, are kept apart in `texts`. A price lookup reads one index
+  bucket and one price, with no text dragged through the cache. Callers
+  still receive whole MenuItems, assembled from the three arrays.
+
   Class Invariant:
-    1. The items are stored in a dynamically allocated array.
+    1. The items are stored in slots 0 to size - 1 of three parallel,
+       dynamically allocated arrays: ids, prices and texts.
     2. The size variable represents the number of items currently in the Menu.
-    3. The capacity variable determines the maximum number of items the array
+    3. The capacity variable determines the maximum number of items the arrays
        can currently hold. It is increased dynamically as needed.
+    4. Every item in the arrays has a positive ID and exactly one entry in
+       the id index, an open-addressing hash table mapping the item's ID to
+       its slot.
+       The index is kept at most half full so probes stay short.
+    5. While `image` is set, the items live in a mapped snapshot instead:
+       the arrays are empty and every lookup is served from the image. The
+       first change to the Menu copies the items into the arrays
+       (materialize()).
+       The text of an entry is interned the first time it is read and
+       kept in `imageText`, so, like searches, lookups in a snapshot must
+       not run concurrently with each other.
+    6. While `searchIndexed` is set, `searchIndex` holds exactly the items
+       of the Menu, and adding or deleting an item updates it. It is
+       cleared when a file or snapshot is loaded, and the next search
+       indexes every item.
 -----------------------------------------------------------------------------*/
 
 #ifndef MENU_H
 #define MENU_H
 
 #include "MenuItem.h"
+#include "MappedFile.h"
+#include "MenuSearch.h"
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
@@ -36,26 +73,53 @@ public:
       Construct a Menu object with a default or specified capacity.
 
       Precondition:  None.
-      Postcondition: The Menu is initialized with a dynamic array of the 
+      Postcondition: The Menu is initialized with dynamic arrays of the 
                      specified capacity, size is set to 0.
     ------------------------------------------------------------------------*/
 
     ~Menu();
     /*------------------------------------------------------------------------
-      Destructor: Releases dynamically allocated memory for the array.
+      Destructor: Releases dynamically allocated memory for the arrays.
+
+      Precondition:  None.
+      Postcondition: The memory for the arrays is deallocated.
+    ------------------------------------------------------------------------*/
+
+    /***** Move Operations *****/
+    Menu(Menu&& other) noexcept;
+    /*------------------------------------------------------------------------
+      Move constructor: Take over the items and id index of another Menu.
 
       Precondition:  None.
-      Postcondition: The memory for the array is deallocated.
+      Postcondition: The new Menu holds other's items. other is left as an
+                     empty Menu that allocates storage again when an item is
+                     added.
+    ------------------------------------------------------------------------*/
+
+    Menu& operator=(Menu&& other) noexcept;
+    /*------------------------------------------------------------------------
+      Move the items and id index of another Menu into this one.
+
+      Precondition:  None.
+      Postcondition: This Menu releases its storage and holds other's items.
+                     other is left as an empty Menu.
+    ------------------------------------------------------------------------*/
+
+    Menu(const Menu& other) = delete;
+    Menu& operator=(const Menu& other) = delete;
+    /*------------------------------------------------------------------------
+      Menus own their storage and are not copied; Orders refer to them by
+      address.
     ------------------------------------------------------------------------*/
 
     /***** Item Retrieval and Management *****/
-    MenuItem getItemById(int id);
+    MenuItem getItemById(int id) const;
     /*------------------------------------------------------------------------
-      Retrieve a MenuItem by its ID.
+      Retrieve a MenuItem by its ID in constant expected time.
 
-      Precondition:  The Menu contains at least one item.
-      Postcondition: Returns the MenuItem with the specified ID. Throws an 
-                     exception if the item is not found.
+      Precondition:  None.
+      Postcondition: Returns the MenuItem with the specified ID, or a 
+                     MenuItem with an ID of -1 if the item is not found.
     ------------------------------------------------------------------------*/
 
     void addItem(const MenuItem& item);
@@ -64,7 +128,40 @@ public:
 
       Precondition:  None.
       Postcondition: The specified MenuItem is added to the Menu. Resizes the 
-                     array if necessary.
+                     arrays if necessary. An existing item with the same ID is
+                     replaced instead, keeping IDs unique. An item whose ID
+                     is not positive is rejected with an error on cerr.
+    ------------------------------------------------------------------------*/
+
+    void addItem(MenuItem&& item);
+    /*------------------------------------------------------------------------
+      Add a temporary MenuItem to the Menu.
+
+      Precondition:  None.
+      Postcondition: Same as addItem(const MenuItem&); item is left valid
+                     but unspecified.
+    ------------------------------------------------------------------------*/
+
+    bool getPrice(int id, Money& price) const;
+    /*------------------------------------------------------------------------
+      Retrieve the price of an item by its ID, without its text.
+
+      Precondition:  None.
+      Postcondition: Returns true and sets price if the item is on the
+                     Menu; returns false and leaves price unchanged
+                     otherwise.
+    ------------------------------------------------------------------------*/
+
+    int getPrices(const vector<int>& itemIds, vector<Money>& found) const;
+    /*------------------------------------------------------------------------
+      Retrieve the prices of many items at once.
+
+      Precondition:  None.
+      Postcondition: found[i] is the price of the item with ID itemIds[i],
+                     or Money() (never a valid price) if it is not on the
+                     Menu. Returns the number of items found. The lookups
+                     are issued in batches so that their cache misses
+                     overlap.
     ------------------------------------------------------------------------*/
 
     bool deleteItem(int id);
@@ -73,7 +170,9 @@ public:
 
       Precondition:  The Menu contains at least one item.
       Postcondition: The MenuItem with the specified ID is removed from the 
-                     Menu. Returns true if successful, false otherwise.
+                     Menu. Returns true if successful, false otherwise. The 
+                     last item is moved into the freed slot, so the order of
+                     the remaining items may change.
     ------------------------------------------------------------------------*/
 
     void reset();
@@ -86,20 +185,54 @@ public:
 
     int getLastItemId() const;
     /*------------------------------------------------------------------------
-      Retrieve the ID of the last MenuItem added.
+      Retrieve the largest ID of any MenuItem added since the last reset.
 
-      Precondition:  The Menu contains at least one item.
-      Postcondition: Returns the ID of the last MenuItem in the array.
+      Precondition:  None.
+      Postcondition: Returns the largest ID added, or 0 if the Menu is empty.
+                     Deleting items does not lower it, so new IDs derived 
+                     from it never collide with existing ones.
+    ------------------------------------------------------------------------*/
+
+    /***** Search *****/
+    vector<MenuItem> search(const string& query, int limit = 10) const;
+    /*------------------------------------------------------------------------
+      Find items by name or description, as a cashier types.
+
+      Precondition:  None.
+      Postcondition: Returns up to limit items that have words starting
+                     with every word of query, ignoring case: matches in
+                     the name first, the exact word before longer ones.
+                     The first search after loading a file or snapshot
+                     indexes every item; later ones take microseconds.
+    ------------------------------------------------------------------------*/
+
+    /***** Capacity *****/
+    void reserve(int capacity);
+    /*------------------------------------------------------------------------
+      Make room for at least the given number of items.
+
+      Precondition:  None.
+      Postcondition: The arrays can hold capacity items and the id index
+                     capacity IDs without being resized again. A smaller
+                     capacity than the current one changes nothing.
     ------------------------------------------------------------------------*/
 
     /***** File Operations *****/
     void loadFromFile(const string& filename);
     /*------------------------------------------------------------------------
-      Load Menu items from a file.
+      Load Menu items from a file with one "id,name,description,price" line
+      per item.
 
-      Precondition:  The file must exist and contain valid MenuItem data.
-      Postcondition: The Menu is populated with items from the file. Resizes 
-                     the array if necessary.
+      Precondition:  None.
+      Postcondition: The Menu is populated with items from the file. The
+                     file is scanned in place (memory-mapped where the
+                     system allows it) and room for every line is reserved
+                     before parsing; the search index is rebuilt by the
+                     next search. Malformed lines, including those whose
+                     ID is not a positive integer, are skipped and
+                     reported on cerr with their line number; blank lines
+                     are ignored. If the file cannot be opened an error is
+                     reported and the Menu is unchanged.
     ------------------------------------------------------------------------*/
 
     void saveToFile(const string& filename) const;
@@ -111,6 +244,49 @@ public:
                      readable format.
     ------------------------------------------------------------------------*/
 
+    /***** Binary Snapshots *****/
+    bool saveSnapshot(const string& filename) const;
+    /*------------------------------------------------------------------------
+      Save the Menu as a binary snapshot.
+
+      The snapshot is, in native byte order (little-endian on every
+      supported machine):
+        header   32 bytes: magic "RMSMENU" + NUL, version (uint32, 1),
+                 byte-order mark (uint32, 0x01020304), item count (uint32),
+                 last item ID (int32), string blob size (uint32) and a
+                 checksum (uint32) of everything after the header.
+        table    one 24-byte entry per item, sorted by ID: ID (int32),
+                 padding, price in cents (int64), then the blob offsets of
+                 the name and description (uint32 each). Each string ends
+                 at the next string's offset.
+        blob     names and descriptions, back to back.
+
+      Precondition:  The output file must be writable.
+      Postcondition: Returns true if every item was written; otherwise
+                     reports the error on cerr and returns false.
+    ------------------------------------------------------------------------*/
+
+    bool loadSnapshot(const string& filename);
+    /*------------------------------------------------------------------------
+      Replace the Menu with the items of a binary snapshot.
+
+      Precondition:  None.
+      Postcondition: Returns true if the file is a valid snapshot. The file
+                     is mapped rather than parsed: lookups are answered from
+                     it until the Menu is first changed. Otherwise reports
+                     the problem on cerr, returns false and leaves the Menu
+                     unchanged.
+    ------------------------------------------------------------------------*/
+
+    static bool isSnapshotFile(const string& filename);
+    /*------------------------------------------------------------------------
+      Check whether a file starts like a binary snapshot.
+
+      Precondition:  None.
+      Postcondition: Returns true if the file exists and begins with the
+                     snapshot magic, false for text menus and missing files.
+    ------------------------------------------------------------------------*/
+
     /***** Overloaded Operators *****/
     friend ostream& operator<<(ostream& out, const Menu& menu);
     /*------------------------------------------------------------------------
@@ -122,17 +298,146 @@ public:
     ------------------------------------------------------------------------*/
 
 private:
-    MenuItem* array;  // Dynamic array of MenuItem objects
-    int capacity;     // Maximum capacity of the array
+    struct MenuText {
+        StringTable::Handle name;
+        StringTable::Handle description;
+    };
+
+    struct IndexBucket {
+        int id;       // Item ID, EMPTY_SLOT if unused
+        int slot;     // Position of the item in the arrays
+    };
+
+    int* ids;         // Hot: ID of the item in each slot
+    Money* prices;    // Hot: price of the item in each slot
+    MenuText* texts;  // Cold: name and description of the item in each slot
+    int capacity;     // Maximum capacity of the arrays
     int size;         // Current number of items in the Menu
+    int lastId;       // Largest ID added since the last reset
+
+    IndexBucket* idIndex; // Hash table of the item IDs
+    int indexCapacity;// Number of buckets, always a power of two
+
+    static const int EMPTY_SLOT = -2; // Marks an unused bucket (IDs are >= 1)
+
+    struct SnapshotEntry;             // One item of a snapshot table (Menu.cpp)
+    MappedFile* image;                // Mapped snapshot, NULL once materialized
+    const SnapshotEntry* imageItems;  // Snapshot table, sorted by ID
+    const char* imageStrings;         // Snapshot string blob
+    int imageSize;                    // Number of items in the snapshot
+    unsigned int imageStringBytes;    // Size of the string blob
+    mutable StringTable::Handle* imageText; // Interned name and description
+                                            // of each entry, EMPTY until read
+
+    mutable MenuSearch searchIndex;   // Words of the names and descriptions
+    mutable bool searchIndexed;       // False until a snapshot is indexed
+
+    MenuItem itemAt(int slot) const;
+    void setSlot(int slot, const MenuItem& item);
+    /*------------------------------------------------------------------------
+      Assemble the MenuItem of a slot, or spread one over a slot.
+
+      Precondition:  0 <= slot < capacity; itemAt() reads slots below size.
+      Postcondition: itemAt() returns the item in slot; setSlot() stores
+                     item's ID, price and text handles in slot, leaving
+                     the id index to the caller.
+    ------------------------------------------------------------------------*/
+
+    MenuItem imageItem(int entry) const;
+    /*------------------------------------------------------------------------
+      Build the MenuItem of one snapshot table entry.
+
+      Precondition:  image is set and 0 <= entry < imageSize.
+      Postcondition: Returns the item, interning its text on first use;
+                     strings that point outside the blob come back empty.
+    ------------------------------------------------------------------------*/
+
+    int findImageEntry(int id) const;
+    /*------------------------------------------------------------------------
+      Binary search the snapshot table for an ID.
+
+      Precondition:  image is set.
+      Postcondition: Returns the entry holding id, or -1 if there is none.
+    ------------------------------------------------------------------------*/
+
+    void materialize();
+    /*------------------------------------------------------------------------
+      Copy the items of the mapped snapshot into the arrays and release it.
+
+      Precondition:  None.
+      Postcondition: image is NULL and the arrays and id index hold every
+                     item of the Menu, in ID order if they came from a
+                     snapshot. Does nothing if no snapshot is mapped.
+    ------------------------------------------------------------------------*/
+
+    void releaseImage();
+    /*------------------------------------------------------------------------
+      Unmap the snapshot without copying its items.
+
+      Precondition:  None.
+      Postcondition: image is NULL and imageSize is 0.
+    ------------------------------------------------------------------------*/
 
     void resize();
     /*------------------------------------------------------------------------
-      Resize the dynamic array when it reaches capacity.
+      Resize the dynamic arrays when they reach capacity.
+
+      Precondition:  None.
+      Postcondition: The arrays' capacity is doubled with reserve(). A Menu
+                     without arrays (after being moved from) gets the
+                     default capacity.
+    ------------------------------------------------------------------------*/
+
+    int findSlot(int id) const;
+    /*------------------------------------------------------------------------
+      Look up the slot of the item with the given ID.
+
+      Precondition:  None.
+      Postcondition: Returns the item's slot in the arrays, or -1 if no item
+                     with that ID is in the Menu.
+    ------------------------------------------------------------------------*/
+
+    int homeBucket(int id) const;
+    /*------------------------------------------------------------------------
+      Hash an ID to its preferred bucket in the id index.
+
+      Precondition:  indexCapacity is a power of two.
+      Postcondition: Returns a bucket number in [0, indexCapacity).
+    ------------------------------------------------------------------------*/
+
+    int bucketFor(int id) const;
+    /*------------------------------------------------------------------------
+      Find the bucket of the id index that holds, or would hold, an ID.
+
+      Precondition:  The index has at least one unused bucket.
+      Postcondition: Returns the bucket containing id, or the first unused 
+                     bucket on id's probe sequence if id is not indexed.
+    ------------------------------------------------------------------------*/
+
+    void indexInsert(int id, int slot);
+    /*------------------------------------------------------------------------
+      Record that the item with the given ID lives at the given slot.
+
+      Precondition:  The index is less than half full.
+      Postcondition: id maps to slot; an existing entry for id is updated.
+    ------------------------------------------------------------------------*/
+
+    void indexErase(int id);
+    /*------------------------------------------------------------------------
+      Remove an ID from the id index.
 
       Precondition:  None.
-      Postcondition: The array's capacity is doubled, and existing items
-                     are copied to the new array.
+      Postcondition: id is no longer indexed. Later entries of the same probe
+                     run are shifted back so no tombstones are left behind.
+    ------------------------------------------------------------------------*/
+
+    void rebuildIndex(int buckets);
+    /*------------------------------------------------------------------------
+      Reallocate the id index with the given number of buckets.
+
+      Precondition:  buckets is a power of two greater than 2 * size.
+      Postcondition: The index holds exactly the items currently in the
+                     arrays.
     ------------------------------------------------------------------------*/
 };
 
@@ -7,32 +7,62 @@ using namespace std;
 
 #include "MenuItem.h"
 
+// "undefined", interned once for every default-constructed item; the
+// default price of 0 is raised to 0.99 as setPrice() would
+static StringTable::Handle undefinedText(){
+    static const StringTable::Handle handle = StringTable::intern("undefined");
+    return handle;
+}
+
+//--- Definition of MenuItem default constructor
+MenuItem::MenuItem()
+    : id(0), name(undefinedText()), description(undefinedText()), price(Money(99)) {
+}
+
 //--- Definition of MenuItem constructor
-MenuItem::MenuItem(int id, const string& name,
-     const string& description, double price){
+MenuItem::MenuItem(int id, string_view name,
+     string_view description, Money price){
     setId(id);
     setName(name);
     setDescription(description);
     setPrice(price);
 }
 
+//--- Definition of MenuItem constructor taking interned text
+MenuItem::MenuItem(int id, StringTable::Handle name,
+     StringTable::Handle description, Money price)
+    : name(name), description(description) {
+    setId(id);
+    setPrice(price);
+}
+
 //--- Definition of getId()
 int MenuItem::getId() const{
     return id;
 }
 
 //--- Definition of getName()
-string MenuItem::getName() const{
-    return name;
+string_view MenuItem::getName() const{
+    return StringTable::get(name);
 }
 
 //--- Definition of getDescription()
-string MenuItem::getDescription() const{
+string_view MenuItem::getDescription() const{
+    return StringTable::get(description);
+}
+
+//--- Definition of getNameHandle()
+StringTable::Handle MenuItem::getNameHandle() const{
+    return name;
+}
+
+//--- Definition of getDescriptionHandle()
+StringTable::Handle MenuItem::getDescriptionHandle() const{
     return description;
 }
 
 //--- Definition of getPrice()
-double MenuItem::getPrice() const{
+Money MenuItem::getPrice() const{
     return price;
 }
 
@@ -47,19 +77,19 @@ void MenuItem::setId(int id){
 }
 
 //--- Definition of setName()
-void MenuItem::setName(const string& name){
-    this->name = name;
+void MenuItem::setName(string_view name){
+    this->name = StringTable::intern(name);
 }
 
 //--- Definition of setDescription()
-void MenuItem::setDescription(const string& description){
-    this->description = description;
+void MenuItem::setDescription(string_view description){
+    this->description = StringTable::intern(description);
 }
 
 //--- Definition of setPrice()
-void MenuItem::setPrice(double price){
-    if (price <= 0.0){
-        this->price = 0.99;
+void MenuItem::setPrice(Money price){
+    if (price <= Money()){
+        this->price = Money(99);
     }
     else{
         this->price = price;
@@ -69,7 +99,7 @@ void MenuItem::setPrice(double price){
 //--- Definition of operator<<
 ostream& operator<<(ostream& out, const MenuItem& menuItem){
     out << "ID: " << menuItem.id << ", Name: " 
-        << menuItem.name << ", Price: $" << menuItem.price << endl;
+        << menuItem.getName() << ", Price: $" << menuItem.price << endl;
         
     return out;
 }
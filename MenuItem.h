@@ -2,9 +2,13 @@
  
   This header file defines the MenuItem class, which represents an individual 
   item on a menu. Each MenuItem has a unique ID, name, description, and price.
+  The name and description are interned in the StringTable: an item holds
+  their handles, so it is 24 bytes, copies without allocating, and its
+  accessors return views of the shared text.
   
   Basic operations:
     Constructor:     Constructs a MenuItem with default or specified values.
+    Copy and move:   Copies a MenuItem, handles and all.
     Accessors:       Get individual attributes (ID, name, description, price).
     Mutators:        Set individual attributes (ID, name, description, price).
     Overloaded <<:   Outputs the MenuItem details to an output stream.
@@ -12,26 +16,56 @@
   Class Invariant:
     1. ID is a unique positive integer.
     2. Name and description are non-empty strings.
-    3. Price is a non-negative double value.
+    3. Price is a positive amount of Money.
 -----------------------------------------------------------------------------*/
 #ifndef MENUITEM_H
 #define MENUITEM_H
 
+#include "Money.h"
+#include "StringTable.h"
 #include <iostream>
+#include <string_view>
 
 using namespace std;
 
 class MenuItem {
 public:
     /***** Constructor *****/
-    MenuItem(int id = 0, const string& name = "undefined",
-     const string& description = "undefined",double price = 0.0);
+    MenuItem();
+    MenuItem(int id, string_view name = "undefined",
+     string_view description = "undefined", Money price = Money());
     /*------------------------------------------------------------------------
       Construct a MenuItem object with default or specified values.
 
       Precondition:  None.
       Postcondition: MenuItem is initialized with given ID, name, description,
-                     and price, or default values if not provided.
+                     and price, or default values if not provided. The
+                     default constructor interns nothing, so arrays of
+                     items are cheap to allocate.
+    ------------------------------------------------------------------------*/
+
+    MenuItem(int id, StringTable::Handle name, StringTable::Handle description,
+     Money price);
+    /*------------------------------------------------------------------------
+      Construct a MenuItem from text that is already interned.
+
+      Precondition:  name and description were returned by
+                     StringTable::intern().
+      Postcondition: MenuItem is initialized as by the constructor above,
+                     without looking up its text.
+    ------------------------------------------------------------------------*/
+
+    /***** Copy and Move *****/
+    MenuItem(const MenuItem& other) = default;
+    MenuItem(MenuItem&& other) noexcept = default;
+    MenuItem& operator=(const MenuItem& other) = default;
+    MenuItem& operator=(MenuItem&& other) noexcept = default;
+    /*------------------------------------------------------------------------
+      Copy or move a MenuItem.
+
+      Precondition:  None.
+      Postcondition: The MenuItem holds other's ID, name, description and 
+                     price. Both copy a few integers; other is unchanged.
     ------------------------------------------------------------------------*/
 
     /***** Accessor Functions *****/
@@ -43,23 +77,35 @@ public:
       Postcondition: Returns the ID of the menu item.
     ------------------------------------------------------------------------*/
 
-    string getName() const;
+    string_view getName() const;
     /*------------------------------------------------------------------------
       Retrieve the name of the MenuItem.
 
       Precondition:  None.
-      Postcondition: Returns the name of the menu item.
+      Postcondition: Returns a view of the name of the menu item, valid
+                     until the program exits.
     ------------------------------------------------------------------------*/
 
-    string getDescription() const;
+    string_view getDescription() const;
     /*------------------------------------------------------------------------
       Retrieve the description of the MenuItem.
 
       Precondition:  None.
-      Postcondition: Returns the description of the menu item.
+      Postcondition: Returns a view of the description of the menu item,
+                     valid until the program exits.
+    ------------------------------------------------------------------------*/
+
+    StringTable::Handle getNameHandle() const;
+    StringTable::Handle getDescriptionHandle() const;
+    /*------------------------------------------------------------------------
+      Retrieve the interned handles of the name and description.
+
+      Precondition:  None.
+      Postcondition: Returns the handles; two items have the same name
+                     exactly when their name handles are equal.
     ------------------------------------------------------------------------*/
 
-    double getPrice() const;
+    Money getPrice() const;
     /*------------------------------------------------------------------------
       Retrieve the price of the MenuItem.
 
@@ -76,28 +122,31 @@ public:
       Postcondition: Updates the menu item's ID to the specified value.
     ------------------------------------------------------------------------*/
 
-    void setName(const string& name);
+    void setName(string_view name);
     /*------------------------------------------------------------------------
       Set the name of the MenuItem.
 
       Precondition:  Name must be a string.
-      Postcondition: Updates the menu item's name to the specified value.
+      Postcondition: Updates the menu item's name to the specified value,
+                     interning it.
     ------------------------------------------------------------------------*/
     
-    void setDescription(const string& description);
+    void setDescription(string_view description);
     /*------------------------------------------------------------------------
       Set the description of the MenuItem.
 
       Precondition:  Description must be a string.
-      Postcondition: Updates the menu item's description to the specified value.
+      Postcondition: Updates the menu item's description to the specified
+                     value, interning it.
     ------------------------------------------------------------------------*/
     
-    void setPrice(double price);
+    void setPrice(Money price);
     /*------------------------------------------------------------------------
       Set the price of the MenuItem.
 
       Precondition:  Price must be a non-negative value.
-      Postcondition: Updates the menu item's price to the specified value.
+      Postcondition: Updates the menu item's price to the specified value,
+                     or to 0.99 if the value is not positive.
     ------------------------------------------------------------------------*/
 
     /***** Overloaded Operators *****/
@@ -111,10 +160,10 @@ public:
     ------------------------------------------------------------------------*/
     
 private:
-    int id;                 // Unique ID for the menu item
-    string name;            // Name of the menu item
-    string description;     // Description of the menu item
-    double price;           // Price of the menu item
+    int id;                          // Unique ID for the menu item
+    StringTable::Handle name;        // Name of the menu item
+    StringTable::Handle description; // Description of the menu item
+    Money price;                     // Price of the menu item
 };
 
 #endif // MENUITEM_H
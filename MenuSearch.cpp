@@ -0,0 +1,365 @@
+/*-- MenuSearch.cpp ----------------------------------------------------------
+              This file implements MenuSearch member functions.
+--------------------------------------------------------------------------*/
+
+#include "MenuSearch.h"
+#include <algorithm>
+
+// Rank order of postings: earlier words in shorter fields first, then IDs
+static bool ranksBefore(unsigned short positionA, unsigned short wordsA, int idA,
+                        unsigned short positionB, unsigned short wordsB, int idB){
+    if(positionA != positionB)
+        return positionA < positionB;
+    if(wordsA != wordsB)
+        return wordsA < wordsB;
+    return idA < idB;
+}
+
+static bool isWordByte(unsigned char c){
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+        || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+//--- Definition of MenuSearch constructor
+MenuSearch::MenuSearch() : poolGarbage(0), nextGeneration(1) {
+    clear();
+}
+
+static char lower(char c){
+    return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+static bool sameWord(string_view a, string_view b){
+    if(a.size() != b.size())
+        return false;
+    for(size_t i = 0; i < a.size(); i++){
+        if(lower(a[i]) != lower(b[i]))
+            return false;
+    }
+    return true;
+}
+
+// Splits text into its distinct words, as views of text in their case;
+// indexing lowers them while walking the trie, without copies
+static void splitWords(string_view text, vector<string_view>& words){
+    words.clear();
+    size_t i = 0;
+    while(i < text.size()){
+        while(i < text.size() && !isWordByte((unsigned char)text[i]))
+            i++;
+        size_t start = i;
+        while(i < text.size() && isWordByte((unsigned char)text[i]))
+            i++;
+        if(i == start)
+            break;
+
+        string_view word = text.substr(start, i - start);
+        bool repeated = false;
+        for(size_t w = 0; w < words.size() && !repeated; w++){
+            repeated = sameWord(words[w], word);
+        }
+        if(!repeated)
+            words.push_back(word);
+    }
+}
+
+//--- Definition of tokenize()
+void MenuSearch::tokenize(string_view text, vector<string>& words){
+    vector<string_view> views;
+    splitWords(text, views);
+
+    words.clear();
+    for(size_t w = 0; w < views.size(); w++){
+        string word(views[w]);
+        for(size_t i = 0; i < word.size(); i++){
+            word[i] = lower(word[i]);
+        }
+        words.push_back(move(word));
+    }
+}
+
+//--- Definition of insertWord()
+int MenuSearch::insertWord(Trie& trie, string_view word){
+    int node = 0;
+    for(size_t i = 0; i < word.size(); i++){
+        char letter = lower(word[i]);
+
+        // Find the child, or the sibling to insert it after
+        int previous = NO_NODE;
+        int child = trie.nodes[node].firstChild;
+        while(child != NO_NODE && (unsigned char)trie.nodes[child].letter < (unsigned char)letter){
+            previous = child;
+            child = trie.nodes[child].nextSibling;
+        }
+
+        if(child == NO_NODE || trie.nodes[child].letter != letter){
+            Node created = { node, NO_NODE, child, NO_NODE, 0,
+                             trie.nodes[node].depth + 1, letter };
+            trie.nodes.push_back(created);
+            int index = (int)trie.nodes.size() - 1;
+            if(previous == NO_NODE)
+                trie.nodes[node].firstChild = index;
+            else
+                trie.nodes[previous].nextSibling = index;
+            child = index;
+        }
+        node = child;
+    }
+
+    if(trie.nodes[node].list == NO_NODE){
+        PostingList list;
+        list.live = 0;
+        list.sorted = true;
+        trie.lists.push_back(list);
+        trie.nodes[node].list = (int)trie.lists.size() - 1;
+    }
+    return node;
+}
+
+//--- Definition of findPrefix()
+int MenuSearch::findPrefix(const Trie& trie, string_view prefix) const {
+    int node = 0;
+    for(size_t i = 0; i < prefix.size() && node != NO_NODE; i++){
+        int child = trie.nodes[node].firstChild;
+        while(child != NO_NODE && trie.nodes[child].letter != prefix[i])
+            child = trie.nodes[child].nextSibling;
+        node = child;
+    }
+    return node;
+}
+
+//--- Definition of add()
+void MenuSearch::add(int id, string_view name, string_view description){
+    remove(id);
+
+    Entry& entry = entries[id];
+    entry.generation = nextGeneration++;
+    entry.firstWord = (int)wordPool.size();
+    entry.wordCount[NAME] = addField(NAME, id, entry.generation, name);
+    entry.wordCount[DESCRIPTION] = addField(DESCRIPTION, id, entry.generation, description);
+}
+
+//--- Definition of addField()
+int MenuSearch::addField(Field field, int id, unsigned int generation, string_view text){
+    Trie& trie = tries[field];
+
+    vector<string_view>& words = scratchWords;
+    splitWords(text, words);
+    unsigned short count = (unsigned short)min(words.size(), (size_t)65535);
+
+    for(size_t i = 0; i < words.size(); i++){
+        int node = insertWord(trie, words[i]);
+        wordPool.push_back(node);
+
+        Posting posting = { id, generation, (unsigned short)min(i, (size_t)65535), count };
+        PostingList& list = trie.lists[trie.nodes[node].list];
+
+        // Lists built in rank order (IDs loaded in order) never need sorting
+        if(list.sorted && !list.postings.empty()){
+            const Posting& last = list.postings.back();
+            list.sorted = ranksBefore(last.position, last.words, last.itemId,
+                                      posting.position, posting.words, posting.itemId);
+        }
+        list.postings.push_back(posting);
+        list.live++;
+
+        for(int up = node; up != NO_NODE; up = trie.nodes[up].parent)
+            trie.nodes[up].subtreeItems++;
+    }
+    return (int)words.size();
+}
+
+//--- Definition of remove()
+bool MenuSearch::remove(int id){
+    unordered_map<int, Entry>::iterator found = entries.find(id);
+    if(found == entries.end())
+        return false;
+
+    Entry entry = found->second;
+    entries.erase(found);
+    retire(entry);
+
+    poolGarbage += entry.wordCount[NAME] + entry.wordCount[DESCRIPTION];
+    if(poolGarbage > 1024 && poolGarbage > (int)wordPool.size() / 2)
+        compactPool();
+    return true;
+}
+
+//--- Definition of retire()
+void MenuSearch::retire(const Entry& entry){
+    // The postings stay until their list is compacted; their generation
+    // no longer matches an entry
+    int word = entry.firstWord;
+    for(int field = 0; field < FIELD_COUNT; field++){
+        Trie& trie = tries[field];
+        for(int i = 0; i < entry.wordCount[field]; i++, word++){
+            int node = wordPool[word];
+            for(int up = node; up != NO_NODE; up = trie.nodes[up].parent)
+                trie.nodes[up].subtreeItems--;
+
+            PostingList& list = trie.lists[trie.nodes[node].list];
+            list.live--;
+            if(list.postings.size() > 16 && list.live < (int)list.postings.size() / 2){
+                // Removing stale postings keeps the order of the rest
+                vector<Posting> kept;
+                kept.reserve(list.live);
+                for(size_t j = 0; j < list.postings.size(); j++){
+                    if(isLive(list.postings[j]))
+                        kept.push_back(list.postings[j]);
+                }
+                list.postings.swap(kept);
+            }
+        }
+    }
+}
+
+//--- Definition of compactPool()
+void MenuSearch::compactPool(){
+    vector<int> compacted;
+    compacted.reserve(wordPool.size() - poolGarbage);
+
+    unordered_map<int, Entry>::iterator it;
+    for(it = entries.begin(); it != entries.end(); ++it){
+        Entry& entry = it->second;
+        int count = entry.wordCount[NAME] + entry.wordCount[DESCRIPTION];
+        int first = (int)compacted.size();
+        compacted.insert(compacted.end(), wordPool.begin() + entry.firstWord,
+                         wordPool.begin() + entry.firstWord + count);
+        entry.firstWord = first;
+    }
+
+    wordPool.swap(compacted);
+    poolGarbage = 0;
+}
+
+//--- Definition of clear()
+void MenuSearch::clear(){
+    for(int field = 0; field < FIELD_COUNT; field++){
+        vector<Node>().swap(tries[field].nodes);
+        vector<PostingList>().swap(tries[field].lists);
+        Node root = { NO_NODE, NO_NODE, NO_NODE, NO_NODE, 0, 0, '\0' };
+        tries[field].nodes.push_back(root);
+    }
+    unordered_map<int, Entry>().swap(entries);
+    vector<int>().swap(wordPool);
+    poolGarbage = 0;
+}
+
+//--- Definition of reserve()
+void MenuSearch::reserve(int items){
+    if(items > (int)entries.size())
+        entries.reserve(items);
+}
+
+//--- Definition of size()
+int MenuSearch::size() const {
+    return (int)entries.size();
+}
+
+//--- Definition of isLive()
+bool MenuSearch::isLive(const Posting& posting) const {
+    unordered_map<int, Entry>::const_iterator found = entries.find(posting.itemId);
+    return found != entries.end() && found->second.generation == posting.generation;
+}
+
+//--- Definition of hasPrefix()
+bool MenuSearch::hasPrefix(const Trie& trie, const Entry& entry, Field field, int prefixNode) const {
+    int word = entry.firstWord + (field == DESCRIPTION ? entry.wordCount[NAME] : 0);
+    int depth = trie.nodes[prefixNode].depth;
+
+    // The word starts with the prefix if the prefix node is its ancestor
+    for(int i = 0; i < entry.wordCount[field]; i++, word++){
+        int node = wordPool[word];
+        while(trie.nodes[node].depth > depth)
+            node = trie.nodes[node].parent;
+        if(node == prefixNode)
+            return true;
+    }
+    return false;
+}
+
+//--- Definition of collect()
+void MenuSearch::collect(Field field, const vector<string>& words, int limit,
+                         vector<int>& results) const {
+    const Trie& trie = tries[field];
+
+    // Every query word must lead somewhere; list from the rarest one
+    vector<int> prefixes(words.size());
+    size_t rarest = 0;
+    for(size_t i = 0; i < words.size(); i++){
+        prefixes[i] = findPrefix(trie, words[i]);
+        if(prefixes[i] == NO_NODE || trie.nodes[prefixes[i]].subtreeItems == 0)
+            return;
+        if(trie.nodes[prefixes[i]].subtreeItems < trie.nodes[prefixes[rarest]].subtreeItems)
+            rarest = i;
+    }
+
+    // Breadth first: the query word itself, then longer and longer words
+    vector<int> queue(1, prefixes[rarest]);
+    for(size_t next = 0; next < queue.size(); next++){
+        const Node& node = trie.nodes[queue[next]];
+        if(node.subtreeItems == 0)
+            continue; // Only stale postings below
+
+        if(node.list != NO_NODE && trie.lists[node.list].live > 0){
+            const PostingList& list = trie.lists[node.list];
+            if(!list.sorted){
+                sort(list.postings.begin(), list.postings.end(),
+                     [](const Posting& a, const Posting& b){
+                         return ranksBefore(a.position, a.words, a.itemId,
+                                            b.position, b.words, b.itemId);
+                     });
+                list.sorted = true;
+            }
+
+            for(size_t i = 0; i < list.postings.size(); i++){
+                const Posting& posting = list.postings[i];
+                unordered_map<int, Entry>::const_iterator found = entries.find(posting.itemId);
+                if(found == entries.end() || found->second.generation != posting.generation)
+                    continue;
+
+                bool matches = true;
+                for(size_t w = 0; w < words.size() && matches; w++){
+                    if(w != rarest)
+                        matches = hasPrefix(trie, found->second, field, prefixes[w]);
+                }
+                // An item found through two words, or by its name already
+                if(!matches || find(results.begin(), results.end(), posting.itemId) != results.end())
+                    continue;
+
+                results.push_back(posting.itemId);
+                if((int)results.size() >= limit)
+                    return;
+            }
+        }
+
+        for(int child = node.firstChild; child != NO_NODE; child = trie.nodes[child].nextSibling)
+            queue.push_back(child);
+    }
+}
+
+//--- Definition of searchField()
+vector<int> MenuSearch::searchField(Field field, string_view query, int limit) const {
+    vector<string> words;
+    tokenize(query, words);
+
+    vector<int> results;
+    if(!words.empty() && limit > 0)
+        collect(field, words, limit, results);
+    return results;
+}
+
+//--- Definition of search()
+vector<int> MenuSearch::search(string_view query, int limit) const {
+    vector<string> words;
+    tokenize(query, words);
+
+    vector<int> results;
+    if(words.empty() || limit <= 0)
+        return results;
+
+    collect(NAME, words, limit, results);
+    if((int)results.size() < limit)
+        collect(DESCRIPTION, words, limit, results);
+    return results;
+}
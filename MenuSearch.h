@@ -0,0 +1,252 @@
+/*-- MenuSearch.h ------------------------------------------------------------
+
+  This header file defines the MenuSearch class, the text index behind
+  Menu::search(). It finds items by the words of their names and
+  descriptions without scanning the menu.
+
+  Text is split into words at every character that is not a letter or a
+  digit, and letters are lowered, so "Soft Drink" holds the words "soft"
+  and "drink" and searching "DRI" finds it. Every word of the query must
+  match the start of some word of the item.
+
+  Each field (names, descriptions) has a prefix trie of its distinct
+  words. The node that ends a word holds the posting list of the items
+  using that word, with the word's position in the field. A query walks
+  to the node of each query word and lists the items below the most
+  selective one, breadth first: items whose word is the query word itself
+  come first, then longer completions, and within a word those where it
+  comes earlier in a field of fewer words, then by ID. The first `limit`
+  items found are returned, so a query costs about the length of its
+  words plus the results, whatever the size of the menu.
+
+  Name matches rank above description matches.
+
+  Removing an item does not search its posting lists: its postings are
+  left behind as stale, recognised by a generation number that changes
+  every time an ID is added, and a list is compacted once half of it is
+  stale.
+
+  Basic operations:
+    add:               Indexes an item, replacing an older one with its ID.
+    remove:            Removes an item.
+    clear:             Removes every item.
+    reserve:           Makes room for a known number of items.
+    search:            Returns the IDs of the best matches of a query.
+    searchField:       Searches names or descriptions only.
+    tokenize:          Splits text into lowercase words.
+
+  Class Invariant:
+    1. `entries` holds one entry per indexed item ID, with the current
+       generation of that ID and the trie nodes of its distinct words in
+       `wordPool`.
+    2. A posting is live when its item has an entry of the same
+       generation; `live` of a list counts its live postings, and
+       `subtreeItems` of a node the live postings of its subtree.
+    3. Lists whose `sorted` flag is set are in rank order; others are
+       sorted by the next query that reads them, so queries must not run
+       concurrently with each other any more than with changes.
+-----------------------------------------------------------------------------*/
+
+#ifndef MENUSEARCH_H
+#define MENUSEARCH_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+class MenuSearch {
+public:
+    enum Field { NAME = 0, DESCRIPTION = 1, FIELD_COUNT = 2 };
+
+    /***** Constructor *****/
+    MenuSearch();
+    /*------------------------------------------------------------------------
+      Construct an empty index.
+
+      Precondition:  None.
+      Postcondition: size() is 0.
+    ------------------------------------------------------------------------*/
+
+    /***** Maintenance *****/
+    void add(int id, string_view name, string_view description);
+    /*------------------------------------------------------------------------
+      Index an item.
+
+      Precondition:  None.
+      Postcondition: Searches find the item by the words of its name and
+                     description; an item indexed before with the same ID
+                     is no longer found by its old words.
+    ------------------------------------------------------------------------*/
+
+    bool remove(int id);
+    /*------------------------------------------------------------------------
+      Remove an item.
+
+      Precondition:  None.
+      Postcondition: Searches no longer find the item. Returns false if no
+                     item with that ID was indexed.
+    ------------------------------------------------------------------------*/
+
+    void clear();
+    /*------------------------------------------------------------------------
+      Remove every item.
+
+      Precondition:  None.
+      Postcondition: size() is 0 and the memory of the tries is released.
+    ------------------------------------------------------------------------*/
+
+    void reserve(int items);
+    /*------------------------------------------------------------------------
+      Make room for a known number of items.
+
+      Precondition:  None.
+      Postcondition: Adding up to items items does not rehash the ID table.
+    ------------------------------------------------------------------------*/
+
+    int size() const;
+    /*------------------------------------------------------------------------
+      Retrieve the number of items indexed.
+
+      Precondition:  None.
+      Postcondition: Returns the number of distinct IDs indexed.
+    ------------------------------------------------------------------------*/
+
+    /***** Queries *****/
+    vector<int> search(string_view query, int limit) const;
+    /*------------------------------------------------------------------------
+      Find the items that best match a query.
+
+      Precondition:  limit > 0.
+      Postcondition: Returns the IDs of up to limit items, those matching
+                     every query word in their name first, then those
+                     matching them in their description, each in rank
+                     order. Empty if the query has no words.
+    ------------------------------------------------------------------------*/
+
+    vector<int> searchField(Field field, string_view query, int limit) const;
+    /*------------------------------------------------------------------------
+      Find the items that best match a query in one field.
+
+      Precondition:  limit > 0.
+      Postcondition: Returns the IDs of up to limit items matching every
+                     query word in that field, in rank order.
+    ------------------------------------------------------------------------*/
+
+    static void tokenize(string_view text, vector<string>& words);
+    /*------------------------------------------------------------------------
+      Split text into words.
+
+      Precondition:  None.
+      Postcondition: words holds the lowercase words of text, in order,
+                     without repeats. Bytes of UTF-8 characters are kept in
+                     words as they are.
+    ------------------------------------------------------------------------*/
+
+private:
+    struct Posting {
+        int itemId;
+        unsigned int generation;
+        unsigned short position;  // Of the word in the field, from 0
+        unsigned short words;     // Distinct words in the field
+    };
+
+    // Queries sort lists on first use, hence mutable
+    struct PostingList {
+        mutable vector<Posting> postings;
+        int live;                 // Postings of current items
+        mutable bool sorted;      // In rank order
+    };
+
+    // Children are a list of siblings in character order; NO_NODE ends it
+    struct Node {
+        int parent;
+        int firstChild;
+        int nextSibling;
+        int list;                 // Index in lists, NO_NODE if no word ends here
+        int subtreeItems;         // Live postings of this node and below
+        int depth;                // Length of the word prefix
+        char letter;
+    };
+
+    struct Trie {
+        vector<Node> nodes;       // nodes[0] is the root
+        vector<PostingList> lists;
+    };
+
+    struct Entry {
+        unsigned int generation;
+        int firstWord;            // Words of the item in wordPool
+        int wordCount[FIELD_COUNT];
+    };
+
+    static const int NO_NODE = -1;
+
+    Trie tries[FIELD_COUNT];
+    unordered_map<int, Entry> entries;    // Item ID -> its words
+    vector<int> wordPool;                 // Trie nodes of item words
+    int poolGarbage;                      // Pool slots of removed items
+    unsigned int nextGeneration;
+    vector<string_view> scratchWords;     // Words of the field being added
+
+    int insertWord(Trie& trie, string_view word);
+    /*------------------------------------------------------------------------
+      Add the nodes of a word, lowered, to a trie.
+
+      Precondition:  word is not empty.
+      Postcondition: Returns the node that ends word, with a posting list.
+    ------------------------------------------------------------------------*/
+
+    int findPrefix(const Trie& trie, string_view prefix) const;
+    /*------------------------------------------------------------------------
+      Walk a trie along a prefix.
+
+      Precondition:  None.
+      Postcondition: Returns the node of prefix, or NO_NODE.
+    ------------------------------------------------------------------------*/
+
+    int addField(Field field, int id, unsigned int generation, string_view text);
+    void retire(const Entry& entry);
+    /*------------------------------------------------------------------------
+      Add the postings of one field, or mark those of an entry stale.
+
+      Precondition:  For addField, the words of the item's earlier fields
+                     are the last ones in wordPool.
+      Postcondition: Counts along the words' paths are updated. addField()
+                     appends the item's words to wordPool and returns how
+                     many; retire() compacts lists that became half stale.
+    ------------------------------------------------------------------------*/
+
+    void compactPool();
+    /*------------------------------------------------------------------------
+      Drop the pool slots of removed items.
+
+      Precondition:  None.
+      Postcondition: wordPool holds only the words of current entries.
+    ------------------------------------------------------------------------*/
+
+    bool isLive(const Posting& posting) const;
+    bool hasPrefix(const Trie& trie, const Entry& entry, Field field, int prefixNode) const;
+    /*------------------------------------------------------------------------
+      Check a posting, or whether an item has a word under a trie node.
+
+      Precondition:  None.
+      Postcondition: Returns true if the posting's item is current, or if
+                     one of the item's words in field starts with the
+                     prefix of prefixNode.
+    ------------------------------------------------------------------------*/
+
+    void collect(Field field, const vector<string>& words, int limit,
+                 vector<int>& results) const;
+    /*------------------------------------------------------------------------
+      Append the best matches of one field.
+
+      Precondition:  words is not empty.
+      Postcondition: results has grown by the IDs of matching items not
+                     already in it, in rank order, up to limit in all.
+    ------------------------------------------------------------------------*/
+};
+
+#endif // MENUSEARCH_H
@@ -0,0 +1,193 @@
+/*-- Metrics.cpp -------------------------------------------------------------
+              This file implements Metrics member functions.
+--------------------------------------------------------------------------*/
+
+#include "Metrics.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Prometheus name, whether it is a gauge, and help text of each metric,
+// in the order of Metrics::Metric
+static const struct {
+    const char* name;
+    bool gauge;
+    const char* help;
+} METRIC_INFO[Metrics::METRIC_COUNT] = {
+    { "rms_menu_lookups_total", false, "Menu item lookups by ID." },
+    { "rms_menu_lookup_misses_total", false, "Menu item lookups that found no item." },
+    { "rms_menu_resizes_total", false, "Reallocations of the menu item array." },
+    { "rms_menu_index_rebuilds_total", false, "Reallocations of the menu ID index." },
+    { "rms_order_resizes_total", false, "Reallocations of order line arrays." },
+    { "rms_orders_enqueued_total", false, "Orders added to the order queue." },
+    { "rms_orders_dequeued_total", false, "Orders taken from the order queue." },
+    { "rms_orders_cancelled_total", false, "Orders deleted from the order queue." },
+    { "rms_queue_depth", true, "Orders waiting in the order queue." },
+    { "rms_completed_orders", true, "Orders held in the completed order stack." },
+    { "rms_interned_strings", true, "Distinct menu texts in the string table." },
+    { "rms_interned_bytes", true, "Bytes of menu text in the string table." },
+    { "rms_allocation_failures_total", false, "Memory allocations that failed." },
+};
+
+// The blocks of running threads, and what exited threads left behind
+struct MetricsRegistry {
+    mutex registryLock;
+    vector<const Metrics::Block*> blocks;
+    long long retired[Metrics::METRIC_COUNT] = {};
+};
+
+// Never destroyed, so threads exiting during shutdown can still retire
+static MetricsRegistry& registry(){
+    static MetricsRegistry* instance = new MetricsRegistry();
+    return *instance;
+}
+
+// Owns the block of one thread and retires it when the thread exits
+struct MetricsBlockOwner {
+    Metrics::Block block;
+
+    MetricsBlockOwner(){
+        for (int i = 0; i < Metrics::METRIC_COUNT; i++) {
+            block.values[i].store(0, memory_order_relaxed);
+        }
+        MetricsRegistry& shared = registry();
+        lock_guard<mutex> guard(shared.registryLock);
+        shared.blocks.push_back(&block);
+    }
+
+    ~MetricsBlockOwner(){
+        MetricsRegistry& shared = registry();
+        lock_guard<mutex> guard(shared.registryLock);
+        for (int i = 0; i < Metrics::METRIC_COUNT; i++) {
+            shared.retired[i] += block.values[i].load(memory_order_relaxed);
+        }
+        for (size_t i = 0; i < shared.blocks.size(); i++) {
+            if (shared.blocks[i] == &block) {
+                shared.blocks[i] = shared.blocks.back();
+                shared.blocks.pop_back();
+                break;
+            }
+        }
+        Metrics::local = NULL;
+    }
+};
+
+//--- Definition of attach()
+Metrics::Block* Metrics::attach(){
+    thread_local MetricsBlockOwner owner; // Constructed on first use
+    local = &owner.block;
+    return local;
+}
+
+//--- Definition of get()
+long long Metrics::get(Metric metric){
+    MetricsRegistry& shared = registry();
+    lock_guard<mutex> guard(shared.registryLock);
+
+    long long value = shared.retired[metric];
+    for (size_t i = 0; i < shared.blocks.size(); i++) {
+        value += shared.blocks[i]->values[metric].load(memory_order_relaxed);
+    }
+    return value;
+}
+
+//--- Definition of getName()
+const char* Metrics::getName(Metric metric){
+    return METRIC_INFO[metric].name;
+}
+
+//--- Definition of getHelp()
+const char* Metrics::getHelp(Metric metric){
+    return METRIC_INFO[metric].help;
+}
+
+//--- Definition of isGauge()
+bool Metrics::isGauge(Metric metric){
+    return METRIC_INFO[metric].gauge;
+}
+
+//--- Definition of writePrometheus()
+void Metrics::writePrometheus(ostream& out){
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        Metric metric = (Metric)i;
+        out << "# HELP " << getName(metric) << " " << getHelp(metric) << "\n"
+            << "# TYPE " << getName(metric) << " " << (isGauge(metric) ? "gauge" : "counter") << "\n"
+            << getName(metric) << " " << get(metric) << "\n";
+    }
+}
+
+//--- Definition of dumpToFile()
+bool Metrics::dumpToFile(const string& filename){
+    // Written aside and renamed over the old file, so a scraper never
+    // reads a partial dump
+    string temporary = filename + ".tmp";
+    ofstream outFile(temporary);
+    if (!outFile) {
+        cerr << "Error: Unable to open file " << temporary << endl;
+        return false;
+    }
+    writePrometheus(outFile);
+    outFile.close();
+    if (!outFile || rename(temporary.c_str(), filename.c_str()) != 0) {
+        cerr << "Error: Unable to write metrics to " << filename << endl;
+        remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+// State of the background dumping thread
+static mutex dumpLock;
+static condition_variable dumpWake;
+static thread dumpThread;
+static bool dumpStopping = false;
+
+//--- Definition of startDumping()
+void Metrics::startDumping(const string& filename, int intervalSeconds){
+    stopDumping();
+    if (intervalSeconds < 1)
+        intervalSeconds = 1;
+
+    dumpStopping = false;
+    dumpThread = thread([filename, intervalSeconds](){
+        unique_lock<mutex> guard(dumpLock);
+        while (!dumpStopping) {
+            dumpWake.wait_for(guard, chrono::seconds(intervalSeconds),
+                              [](){ return dumpStopping; });
+            guard.unlock();
+            dumpToFile(filename);
+            guard.lock();
+        }
+    });
+}
+
+//--- Definition of stopDumping()
+void Metrics::stopDumping(){
+    if (!dumpThread.joinable())
+        return;
+
+    {
+        lock_guard<mutex> guard(dumpLock);
+        dumpStopping = true;
+    }
+    dumpWake.notify_one();
+    dumpThread.join(); // The thread writes once more on its way out
+}
+
+//--- Definition of printReport()
+void Metrics::printReport(ostream& out){
+#ifdef RMS_NO_METRICS
+    out << "Metrics were disabled when this program was built." << endl;
+#endif
+    out << left << setw(34) << "Metric" << setw(10) << "Type" << right << setw(14) << "Value" << endl;
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        Metric metric = (Metric)i;
+        out << left << setw(34) << getName(metric) << setw(10) << (isGauge(metric) ? "gauge" : "counter")
+            << right << setw(14) << get(metric) << endl;
+    }
+}
@@ -0,0 +1,174 @@
+/*-- Metrics.h ---------------------------------------------------------------
+
+  This header file defines the Metrics class, the process-wide registry of
+  counters and gauges that the hot paths of the system update: menu
+  lookups and misses, array reallocations, queue and stack depth, the
+  size of the interned string table, and allocation failures.
+
+  Each thread updates its own block of values, so an update is a plain
+  add to memory no other thread writes, with no lock and no contended
+  cache line. A block is registered the first time its thread updates a
+  metric and folded into a shared total when the thread exits. Reading a
+  metric adds up the blocks. A gauge is kept the same way, as the sum of
+  the changes made by every thread, so it may go up on one thread and
+  down on another.
+
+  Updates go through the METRIC_ADD and METRIC_INC macros. Building with
+  RMS_NO_METRICS defined compiles every update out; the registry then
+  reports zeros.
+
+  The values can be written to a file in the Prometheus text exposition
+  format, once or every few seconds from a background thread.
+
+  Basic operations:
+    add:               Adds to a metric on the calling thread's block.
+    get:               Reads the current value of a metric.
+    getName / getHelp: Describe a metric.
+    writePrometheus:   Outputs every metric in Prometheus text format.
+    startDumping:      Writes a file periodically from a background thread.
+    stopDumping:       Stops the background thread after a final write.
+    printReport:       Outputs a table of every metric.
+
+  Class Invariant:
+    1. The value of a metric is `retired` plus the values of every block
+       in `blocks`; only the owning thread writes to a block.
+    2. `blocks` and `retired` are guarded by `registryLock`.
+-----------------------------------------------------------------------------*/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+#ifndef RMS_NO_METRICS
+#define METRIC_ADD(metric, amount) Metrics::add(Metrics::metric, (amount))
+#else
+#define METRIC_ADD(metric, amount) ((void)0)
+#endif
+#define METRIC_INC(metric) METRIC_ADD(metric, 1)
+
+class Metrics {
+public:
+    /***** Metrics *****/
+    enum Metric {
+        MENU_LOOKUPS,          // Menu::getItemById calls
+        MENU_LOOKUP_MISSES,    // Lookups answered with the ID -1 sentinel
+        MENU_RESIZES,          // Menu item array reallocations
+        MENU_INDEX_REBUILDS,   // Menu ID index reallocations
+        ORDER_RESIZES,         // Order line array reallocations
+        ORDERS_ENQUEUED,
+        ORDERS_DEQUEUED,
+        ORDERS_CANCELLED,      // Removed from the queue by ID
+        QUEUE_DEPTH,           // Gauge: orders waiting in OrderQueues
+        COMPLETED_DEPTH,       // Gauge: orders in CompletedOrderStacks
+        INTERNED_STRINGS,      // Gauge: distinct texts in the StringTable
+        INTERNED_BYTES,        // Gauge: bytes of text in the StringTable
+        ALLOCATION_FAILURES,   // Failed new(nothrow) allocations
+        METRIC_COUNT
+    };
+
+    static const int DUMP_INTERVAL = 5;  // Default seconds between dumps
+
+    /***** Updating *****/
+    static void add(Metric metric, long long amount){
+        Block* block = local;
+        if(!block)
+            block = attach();
+
+        // Only this thread writes the block: no read-modify-write needed
+        atomic<long long>& value = block->values[metric];
+        value.store(value.load(memory_order_relaxed) + amount, memory_order_relaxed);
+    }
+    /*------------------------------------------------------------------------
+      Add to a metric. Use METRIC_ADD so the call can be compiled out.
+
+      Precondition:  None.
+      Postcondition: The metric has grown by amount (a negative amount
+                     lowers a gauge).
+    ------------------------------------------------------------------------*/
+
+    /***** Reading *****/
+    static long long get(Metric metric);
+    /*------------------------------------------------------------------------
+      Read a metric.
+
+      Precondition:  None.
+      Postcondition: Returns the sum of the updates of every thread, past
+                     and present.
+    ------------------------------------------------------------------------*/
+
+    static const char* getName(Metric metric);
+    static const char* getHelp(Metric metric);
+    static bool isGauge(Metric metric);
+    /*------------------------------------------------------------------------
+      Describe a metric.
+
+      Precondition:  None.
+      Postcondition: Returns its Prometheus name, a one-line description,
+                     and whether it is a gauge rather than a counter.
+    ------------------------------------------------------------------------*/
+
+    static void writePrometheus(ostream& out);
+    /*------------------------------------------------------------------------
+      Output every metric in the Prometheus text exposition format.
+
+      Precondition:  ostream out is open.
+      Postcondition: Outputs HELP, TYPE and a sample line per metric.
+    ------------------------------------------------------------------------*/
+
+    static bool dumpToFile(const string& filename);
+    /*------------------------------------------------------------------------
+      Write every metric to a file in the Prometheus text format.
+
+      Precondition:  None.
+      Postcondition: The file is replaced as a whole, through a temporary
+                     file, so readers never see half of it. Returns false
+                     after reporting an error if it cannot be written.
+    ------------------------------------------------------------------------*/
+
+    static void startDumping(const string& filename, int intervalSeconds);
+    static void stopDumping();
+    /*------------------------------------------------------------------------
+      Dump the metrics periodically.
+
+      Precondition:  intervalSeconds > 0.
+      Postcondition: startDumping() starts a thread that calls dumpToFile()
+                     every intervalSeconds, replacing any earlier one.
+                     stopDumping() writes the file one last time and joins
+                     the thread; it does nothing if none is running.
+    ------------------------------------------------------------------------*/
+
+    static void printReport(ostream& out);
+    /*------------------------------------------------------------------------
+      Output a table of every metric.
+
+      Precondition:  ostream out is open.
+      Postcondition: Outputs the name, kind and value of each metric, or a
+                     note that metrics were compiled out.
+    ------------------------------------------------------------------------*/
+
+private:
+    struct Block {
+        atomic<long long> values[METRIC_COUNT];
+    };
+
+    inline static thread_local Block* local = NULL; // This thread's block
+
+    static Block* attach();
+    /*------------------------------------------------------------------------
+      Register a block for the calling thread.
+
+      Precondition:  The thread has no block yet.
+      Postcondition: local points to a zeroed block in the registry, which
+                     is folded into `retired` when the thread exits.
+    ------------------------------------------------------------------------*/
+
+    friend struct MetricsRegistry;
+    friend struct MetricsBlockOwner;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,147 @@
+/*-- Money.cpp ---------------------------------------------------------------
+              This file implements Money member functions.
+--------------------------------------------------------------------------*/
+
+#include "Money.h"
+#include <climits>
+#include <cmath>
+
+//--- Definition of fromDouble()
+Money Money::fromDouble(double amount){
+    return Money(llround(amount * 100));
+}
+
+//--- Definition of parse()
+bool Money::parse(const char* first, const char* last, Money& amount){
+    // Skip surrounding spaces
+    while(first < last && (*first == ' ' || *first == '\t'))
+        first++;
+    while(last > first && (last[-1] == ' ' || last[-1] == '\t'
+            || last[-1] == '\r' || last[-1] == '\n'))
+        last--;
+
+    bool negative = false;
+    if(first < last && (*first == '-' || *first == '+')){
+        negative = (*first == '-');
+        first++;
+    }
+
+    // Whole units
+    long long units = 0;
+    int digits = 0;
+    while(first < last && *first >= '0' && *first <= '9'){
+        if(units > (LLONG_MAX / 100 - 9) / 10)
+            return false; // Too large to hold in cents
+        units = units * 10 + (*first - '0');
+        first++;
+        digits++;
+    }
+
+    // Fraction: two digits are kept, the third rounds, the rest is ignored
+    long long fraction = 0;
+    if(first < last && *first == '.'){
+        first++;
+        int place = 0;
+        while(first < last && *first >= '0' && *first <= '9'){
+            if(place < 2){
+                fraction = fraction * 10 + (*first - '0');
+            } else if(place == 2 && *first >= '5'){
+                fraction++;
+            }
+            place++;
+            first++;
+            digits++;
+        }
+        if(place == 1)
+            fraction *= 10;
+    }
+
+    if(digits == 0 || first != last)
+        return false; // No digits, or trailing garbage
+
+    long long cents = units * 100 + fraction;
+    amount = Money(negative ? -cents : cents);
+    return true;
+}
+
+//--- Definition of parse() for a string
+bool Money::parse(const string& text, Money& amount){
+    return parse(text.data(), text.data() + text.size(), amount);
+}
+
+//--- Definition of toString()
+string Money::toString() const {
+    // Work on the magnitude as unsigned so LLONG_MIN is handled too
+    unsigned long long magnitude = cents < 0
+        ? 0ULL - (unsigned long long)cents : (unsigned long long)cents;
+
+    string text = (cents < 0 ? "-" : "") + to_string(magnitude / 100);
+
+    int fraction = (int)(magnitude % 100);
+    if(fraction != 0){
+        text += '.';
+        text += (char)('0' + fraction / 10);
+        if(fraction % 10 != 0)
+            text += (char)('0' + fraction % 10);
+    }
+
+    return text;
+}
+
+//--- Definition of addChecked()
+bool Money::addChecked(Money a, Money b, Money& result){
+    if((b.cents > 0 && a.cents > LLONG_MAX - b.cents)
+        || (b.cents < 0 && a.cents < LLONG_MIN - b.cents))
+        return false;
+
+    result = Money(a.cents + b.cents);
+    return true;
+}
+
+//--- Definition of sum()
+bool Money::sum(const Money* amounts, size_t count, Money& total){
+    // Amounts below 2^52 cents in magnitude cannot overflow when up to
+    // 2^10 of them are added, so each block is summed with plain,
+    // branch-free loops and only the block totals are checked
+    const size_t BLOCK = 1024;
+    const long long SAFE_MAGNITUDE = 1LL << 52;
+
+    Money result;
+    for(size_t start = 0; start < count; start += BLOCK){
+        size_t end = start + BLOCK < count ? start + BLOCK : count;
+
+        // Unsigned addition wraps instead of overflowing, and the result
+        // is only used once the magnitudes are known to be safe
+        long long largest = 0;
+        unsigned long long wrappedSum = 0;
+        for(size_t i = start; i < end; i++){
+            long long value = amounts[i].cents;
+            long long magnitude = value < 0 ? -(value + 1) : value; // No overflow
+            largest = magnitude > largest ? magnitude : largest;
+            wrappedSum += (unsigned long long)value;
+        }
+        long long blockSum = (long long)wrappedSum;
+
+        if(largest >= SAFE_MAGNITUDE){
+            // Rare: huge amounts, add them one at a time with checks
+            Money partial;
+            for(size_t i = start; i < end; i++){
+                if(!addChecked(partial, amounts[i], partial))
+                    return false;
+            }
+            blockSum = partial.cents;
+        }
+
+        if(!addChecked(result, Money(blockSum), result))
+            return false;
+    }
+
+    total = result;
+    return true;
+}
+
+//--- Definition of overloaded operator<<()
+ostream& operator<<(ostream& out, Money amount){
+    out << amount.toString();
+    return out;
+}
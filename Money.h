@@ -0,0 +1,150 @@
+/*-- Money.h -----------------------------------------------------------------
+
+  This header file defines the Money class, an exact amount of money stored
+  as a 64-bit count of cents. Prices, order totals and revenue are kept in
+  Money so that adding up thousands of orders never drifts the way binary
+  floating point does, and so that amounts read from and written to files
+  round-trip exactly.
+
+  Basic operations:
+    Constructor:       Constructs a zero amount, or an amount from cents.
+    fromDouble:        Rounds a floating point amount to the nearest cent.
+    parse:             Reads a decimal amount such as "8.99", "3" or "5.5".
+    Accessors:         Get the amount in cents or as a double for display.
+    toString:          Formats the amount without trailing zeros ("5.5").
+    Arithmetic:        Add, subtract and multiply by a quantity.
+    addChecked:        Adds two amounts, reporting overflow.
+    sum:               Adds up an array of amounts, reporting overflow. The
+                       inner loop has no branches so it can be vectorized.
+    Comparisons:       Compare two amounts.
+    Overloaded <<:     Outputs the amount as toString() does.
+
+  Class Invariant:
+    1. The amount is exactly cents / 100 of the currency unit.
+-----------------------------------------------------------------------------*/
+
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+class Money {
+public:
+    /***** Constructors *****/
+    Money() : cents(0) {}
+    explicit Money(long long cents) : cents(cents) {}
+    /*------------------------------------------------------------------------
+      Construct an amount of zero or of the given number of cents.
+
+      Precondition:  None.
+      Postcondition: The amount is cents / 100.
+    ------------------------------------------------------------------------*/
+
+    static Money fromDouble(double amount);
+    /*------------------------------------------------------------------------
+      Convert a floating point amount to Money.
+
+      Precondition:  amount is finite and within the range of Money.
+      Postcondition: Returns amount rounded to the nearest cent.
+    ------------------------------------------------------------------------*/
+
+    static bool parse(const char* first, const char* last, Money& amount);
+    static bool parse(const string& text, Money& amount);
+    /*------------------------------------------------------------------------
+      Read a decimal amount: an optional sign, digits, and an optional
+      fraction. Surrounding spaces are ignored.
+
+      Precondition:  [first, last) is a valid character range.
+      Postcondition: Returns true and stores the amount if the text is a
+                     valid amount; a third fraction digit or more is rounded
+                     half up to the cent. Returns false, leaving amount
+                     unchanged, if the text is malformed or out of range.
+    ------------------------------------------------------------------------*/
+
+    /***** Accessors *****/
+    long long getCents() const { return cents; }
+    /*------------------------------------------------------------------------
+      Retrieve the amount in cents.
+
+      Precondition:  None.
+      Postcondition: Returns the exact number of cents.
+    ------------------------------------------------------------------------*/
+
+    double toDouble() const { return cents / 100.0; }
+    /*------------------------------------------------------------------------
+      Retrieve the amount as a floating point number.
+
+      Precondition:  None.
+      Postcondition: Returns the closest double to the amount. Only meant
+                     for display and ratios, never for further sums.
+    ------------------------------------------------------------------------*/
+
+    string toString() const;
+    /*------------------------------------------------------------------------
+      Format the amount as decimal text.
+
+      Precondition:  None.
+      Postcondition: Returns the amount with up to two fraction digits and
+                     no trailing zeros, e.g. "8.99", "5.5" or "3", which
+                     parse() reads back to the same amount.
+    ------------------------------------------------------------------------*/
+
+    /***** Arithmetic *****/
+    Money operator+(Money other) const { return Money(cents + other.cents); }
+    Money operator-(Money other) const { return Money(cents - other.cents); }
+    Money operator*(long long quantity) const { return Money(cents * quantity); }
+    Money& operator+=(Money other) { cents += other.cents; return *this; }
+    Money& operator-=(Money other) { cents -= other.cents; return *this; }
+    /*------------------------------------------------------------------------
+      Add, subtract, or multiply an amount by a quantity.
+
+      Precondition:  The result is within the range of Money.
+      Postcondition: Returns, or stores, the exact result.
+    ------------------------------------------------------------------------*/
+
+    static bool addChecked(Money a, Money b, Money& result);
+    /*------------------------------------------------------------------------
+      Add two amounts, detecting overflow.
+
+      Precondition:  None.
+      Postcondition: Returns true and stores a + b in result if it is within
+                     the range of Money, otherwise returns false and leaves
+                     result unchanged.
+    ------------------------------------------------------------------------*/
+
+    static bool sum(const Money* amounts, size_t count, Money& total);
+    /*------------------------------------------------------------------------
+      Add up an array of amounts, detecting overflow.
+
+      Precondition:  amounts points to count amounts.
+      Postcondition: Returns true and stores the exact sum in total if no
+                     partial sum leaves the range of Money, otherwise returns
+                     false and leaves total unchanged.
+    ------------------------------------------------------------------------*/
+
+    /***** Comparisons *****/
+    bool operator==(Money other) const { return cents == other.cents; }
+    bool operator!=(Money other) const { return cents != other.cents; }
+    bool operator<(Money other) const { return cents < other.cents; }
+    bool operator<=(Money other) const { return cents <= other.cents; }
+    bool operator>(Money other) const { return cents > other.cents; }
+    bool operator>=(Money other) const { return cents >= other.cents; }
+
+    /***** Overloaded Operators *****/
+    friend ostream& operator<<(ostream& out, Money amount);
+    /*------------------------------------------------------------------------
+      Overload the << operator to output an amount.
+
+      Precondition:  ostream out is open.
+      Postcondition: Outputs the amount formatted as toString() does.
+    ------------------------------------------------------------------------*/
+
+private:
+    long long cents;  // Amount in hundredths of the currency unit
+};
+
+#endif // MONEY_H
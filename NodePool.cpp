@@ -0,0 +1,190 @@
+/*-- NodePool.cpp ------------------------------------------------------------
+              This file implements NodePool member functions.
+--------------------------------------------------------------------------*/
+
+#include "NodePool.h"
+#include "Order.h"
+
+// Every block is aligned like the strictest fundamental type
+static size_t alignUp(size_t bytes){
+    size_t alignment = alignof(max_align_t);
+    return (bytes + alignment - 1) / alignment * alignment;
+}
+
+//--- Definition of NodePool constructor
+NodePool::NodePool(size_t blockSize, int firstSlabBlocks){
+    if(blockSize < sizeof(FreeBlock))
+        blockSize = sizeof(FreeBlock);
+    if(firstSlabBlocks < 1)
+        firstSlabBlocks = 1;
+
+    this->blockSize = alignUp(blockSize);
+    slabHeader = alignUp(sizeof(Slab));
+    nextSlabBlocks = firstSlabBlocks;
+    freeList = NULL;
+    slabs = NULL;
+    next = NULL;
+    end = NULL;
+
+    heapAllocations = 0;
+    allocations = 0;
+    recycled = 0;
+    blocksInUse = 0;
+    blocksFree = 0;
+}
+
+//--- Definition of NodePool destructor
+NodePool::~NodePool(){
+    Slab* current = slabs;
+    Slab* nextSlab;
+
+    // Release every slab; blocks inside them go with it
+    while(current != NULL){
+        nextSlab = current->next;
+        ::operator delete(current);
+        current = nextSlab;
+    }
+
+    slabs = NULL;
+    freeList = NULL;
+}
+
+//--- Definition of grow()
+bool NodePool::grow(){
+    void* memory = ::operator new(slabHeader + blockSize * nextSlabBlocks, nothrow);
+    if(!memory)
+        return false;
+
+    heapAllocations++;
+
+    Slab* slab = static_cast<Slab*>(memory);
+    slab->next = slabs;
+    slabs = slab;
+
+    // Keep the tail of the previous slab (only left over by reserve())
+    while(next != end){
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(next);
+        block->next = freeList;
+        freeList = block;
+        next += blockSize;
+    }
+
+    // New blocks are handed out in address order from next
+    next = static_cast<char*>(memory) + slabHeader;
+    end = next + blockSize * nextSlabBlocks;
+    blocksFree += nextSlabBlocks;
+
+    if(nextSlabBlocks < MAX_SLAB_BLOCKS){
+        nextSlabBlocks *= 2;
+        if(nextSlabBlocks > MAX_SLAB_BLOCKS)
+            nextSlabBlocks = MAX_SLAB_BLOCKS;
+    }
+
+    return true;
+}
+
+//--- Definition of allocate()
+void* NodePool::allocate(size_t bytes){
+    lock_guard<mutex> guard(lock);
+
+    if(bytes > blockSize){
+        // Too large for the pool, fall back to the heap
+        void* memory = ::operator new(bytes, nothrow);
+        if(memory)
+            heapAllocations++;
+        return memory;
+    }
+
+    void* block;
+    if(freeList != NULL){
+        // Reuse a returned block first, it is most likely still in cache
+        block = freeList;
+        freeList = freeList->next;
+        recycled++;
+    } else {
+        if(next == end && !grow())
+            return NULL;
+
+        block = next;
+        next += blockSize;
+    }
+
+    blocksFree--;
+    blocksInUse++;
+    allocations++;
+
+    return block;
+}
+
+//--- Definition of deallocate()
+void NodePool::deallocate(void* block, size_t bytes){
+    if(block == NULL)
+        return;
+
+    if(bytes > blockSize){
+        ::operator delete(block);
+        return;
+    }
+
+    lock_guard<mutex> guard(lock);
+
+    FreeBlock* freed = static_cast<FreeBlock*>(block);
+    freed->next = freeList;
+    freeList = freed;
+    blocksFree++;
+    blocksInUse--;
+}
+
+//--- Definition of reserve()
+bool NodePool::reserve(int blocks){
+    lock_guard<mutex> guard(lock);
+
+    while(blocksFree < blocks){
+        if(!grow())
+            return false;
+    }
+
+    return true;
+}
+
+//--- Definition of getBlockSize()
+size_t NodePool::getBlockSize() const {
+    return blockSize;
+}
+
+//--- Definition of getHeapAllocations()
+long long NodePool::getHeapAllocations() const {
+    lock_guard<mutex> guard(lock);
+    return heapAllocations;
+}
+
+//--- Definition of getAllocations()
+long long NodePool::getAllocations() const {
+    lock_guard<mutex> guard(lock);
+    return allocations;
+}
+
+//--- Definition of getRecycled()
+long long NodePool::getRecycled() const {
+    lock_guard<mutex> guard(lock);
+    return recycled;
+}
+
+//--- Definition of getBlocksInUse()
+int NodePool::getBlocksInUse() const {
+    lock_guard<mutex> guard(lock);
+    return blocksInUse;
+}
+
+//--- Definition of getBlocksFree()
+int NodePool::getBlocksFree() const {
+    lock_guard<mutex> guard(lock);
+    return blocksFree;
+}
+
+//--- Definition of shared()
+NodePool& NodePool::shared(){
+    // Intentionally never deleted: it must outlive every container
+    static NodePool* pool = new NodePool(sizeof(Order) + 2 * sizeof(void*));
+    return *pool;
+}
@@ -0,0 +1,161 @@
+/*-- NodePool.h --------------------------------------------------------------
+
+  This header file defines the NodePool class, a fixed-size block allocator
+  for the linked-list nodes of OrderQueue and CompletedOrderStack. Blocks are
+  carved in address order out of large contiguous slabs, and returned blocks
+  are recycled through a free list before any fresh slab space is used, so
+  once the pool has grown to the peak number of nodes, adding and removing
+  orders no longer touches the heap.
+
+  Basic operations:
+    Constructor:        Creates an empty pool for blocks of a given size.
+    Destructor:         Releases every slab back to the heap.
+    allocate:           Hands out a block, growing the pool by a slab if needed.
+    deallocate:         Returns a block to the free list for reuse.
+    reserve:            Grows the pool ahead of time to hold a number of blocks.
+    Statistics:         Count heap allocations, pool allocations, recycled
+                        blocks and blocks in use, for benchmarks.
+    shared:             Returns the pool shared by the order containers.
+
+  Class Invariant:
+    1. Every block is blockSize bytes and suitably aligned for any object.
+    2. A block is either in use by a caller, on the free list, or not yet
+       handed out from the newest slab (between next and end).
+    3. Slabs are only released when the pool is destroyed.
+    4. allocate, deallocate and reserve may be called from several threads;
+       they are serialized by a mutex held only for a few pointer updates.
+-----------------------------------------------------------------------------*/
+
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+using namespace std;
+
+class NodePool {
+public:
+    /***** Constructor and Destructor *****/
+    NodePool(size_t blockSize, int firstSlabBlocks = 64);
+    /*------------------------------------------------------------------------
+      Construct an empty pool that hands out blocks of blockSize bytes.
+
+      Precondition:  blockSize > 0 and firstSlabBlocks > 0.
+      Postcondition: No memory is allocated yet. The first slab holds
+                     firstSlabBlocks blocks; each later slab doubles in size
+                     up to MAX_SLAB_BLOCKS.
+    ------------------------------------------------------------------------*/
+
+    ~NodePool();
+    /*------------------------------------------------------------------------
+      Destructor: Releases every slab.
+
+      Precondition:  No block handed out by the pool is still in use.
+      Postcondition: All memory owned by the pool is deallocated.
+    ------------------------------------------------------------------------*/
+
+    /***** Block Management *****/
+    void* allocate(size_t bytes);
+    /*------------------------------------------------------------------------
+      Allocate a block of at least the requested size.
+
+      Precondition:  None.
+      Postcondition: Returns a recycled block if one is free, otherwise the
+                     next unused block of the newest slab, adding a slab if
+                     it is full. Requests larger than blockSize
+                     are passed to the heap. Returns NULL if memory
+                     allocation failed.
+    ------------------------------------------------------------------------*/
+
+    void deallocate(void* block, size_t bytes);
+    /*------------------------------------------------------------------------
+      Return a block obtained from allocate() with the same size.
+
+      Precondition:  block is NULL or was returned by allocate(bytes).
+      Postcondition: The block is placed on the free list, or released to
+                     the heap if it was too large for the pool.
+    ------------------------------------------------------------------------*/
+
+    bool reserve(int blocks);
+    /*------------------------------------------------------------------------
+      Make sure at least the given number of blocks are free.
+
+      Precondition:  None.
+      Postcondition: Adds slabs until at least blocks blocks can be handed
+                     out without touching the heap. Returns false if memory
+                     allocation failed.
+    ------------------------------------------------------------------------*/
+
+    /***** Statistics *****/
+    size_t getBlockSize() const;
+    long long getHeapAllocations() const;  // Slabs and oversized blocks from the heap
+    long long getAllocations() const;      // Blocks handed out in total
+    long long getRecycled() const;         // Blocks handed out again after being returned
+    int getBlocksInUse() const;            // Blocks handed out and not yet returned
+    int getBlocksFree() const;             // Blocks available without growing
+    /*------------------------------------------------------------------------
+      Retrieve usage counters of the pool.
+
+      Precondition:  None.
+      Postcondition: Returns the counter; counters only grow, except for
+                     the number of blocks in use and free.
+    ------------------------------------------------------------------------*/
+
+    /***** Shared Pool *****/
+    static NodePool& shared();
+    /*------------------------------------------------------------------------
+      Retrieve the pool used by the OrderQueue and CompletedOrderStack nodes.
+
+      Precondition:  None.
+      Postcondition: Returns a pool whose blocks hold one Order and two node
+                     links. The pool is created on first use and never
+                     destroyed, so containers with static storage duration
+                     can still release their nodes at program exit.
+    ------------------------------------------------------------------------*/
+
+    static const int MAX_SLAB_BLOCKS = 4096; // Upper bound on blocks per slab
+
+private:
+    /***** Free List and Slab Headers *****/
+    struct FreeBlock {
+        FreeBlock* next;  // Next free block
+    };
+
+    struct Slab {
+        Slab* next;       // Next slab owned by the pool
+    };
+
+    size_t blockSize;     // Size of every block, rounded up for alignment
+    size_t slabHeader;    // Bytes reserved at the start of a slab
+    int nextSlabBlocks;   // Number of blocks in the next slab
+    FreeBlock* freeList;  // Returned blocks ready to be handed out again
+    Slab* slabs;          // All slabs, most recent first
+    char* next;           // First never-used block of the newest slab
+    char* end;            // End of the newest slab
+
+    mutable mutex lock;   // Serializes changes to the free list and slabs
+
+    long long heapAllocations;
+    long long allocations;
+    long long recycled;
+    int blocksInUse;
+    int blocksFree;
+
+    bool grow();
+    /*------------------------------------------------------------------------
+      Allocate a new slab and make its blocks available.
+
+      Precondition:  None.
+      Postcondition: Returns true if a slab was added, false if memory
+                     allocation failed. Unused blocks of the previous slab 
+                     are moved to the free list. The next slab will be twice
+                     as large, up to MAX_SLAB_BLOCKS blocks.
+    ------------------------------------------------------------------------*/
+
+    NodePool(const NodePool& other) = delete;
+    NodePool& operator=(const NodePool& other) = delete;
+};
+
+#endif // NODEPOOL_H
@@ -3,48 +3,72 @@
 --------------------------------------------------------------------------*/
 
 #include "Order.h"
+#include "Metrics.h"
+#include <chrono>
+#include <cstring>
 
 //--- Definition of Order constructor
-Order::Order(int id, const string& customerName){
+Order::Order(int id, const string& customerName, const Menu* menu){
     setOrderId(id);
     setCustomerName(customerName);
+    this->menu = menu;
     size = 0;
     capacity = 10;
-    items = new MenuItem[capacity];
+    lines = new OrderLine[capacity];
     status = 'P';
+
+    memset(timestamps, 0, sizeof(timestamps)); // Stamped by whoever takes the order
 }
 
 //--- Definition of Order copy constructor
 Order::Order(const Order& other) {
     orderId = other.orderId;
     customerName = other.customerName;
+    menu = other.menu;
     size = other.size;
     capacity = other.capacity;
     status = other.status;
+    memcpy(timestamps, other.timestamps, sizeof(timestamps));
 
-    // Allocate new memory for the items array
-    items = new MenuItem[capacity];
+    // Allocate new memory for the lines array
+    lines = new OrderLine[capacity];
     for (int i = 0; i < size; i++) {
-        items[i] = other.items[i]; // Copy each item
+        lines[i] = other.lines[i]; // Copy each line
     }
 }
 
+//--- Definition of Order move constructor
+Order::Order(Order&& other) noexcept 
+    : orderId(other.orderId), customerName(move(other.customerName)),
+      menu(other.menu), lines(other.lines), size(other.size),
+      capacity(other.capacity), status(other.status) {
+    memcpy(timestamps, other.timestamps, sizeof(timestamps));
+
+    // Leave other empty so its destructor does not free the lines
+    other.lines = NULL;
+    other.size = 0;
+    other.capacity = 0;
+}
+
 //--- Definition of Order destructor
 Order::~Order(){
-    delete [] items; // Free the memory
+    delete [] lines; // Free the memory
 }
 
 //--- Definition of resize()
 void Order::resize(){
+    METRIC_INC(ORDER_RESIZES);
+
     // Allocate new memory and copy items
-    MenuItem* newArray = new MenuItem[capacity*2];
+    int newCapacity = capacity > 0 ? capacity * 2 : 10;
+    OrderLine* newArray = new OrderLine[newCapacity];
     for(int i = 0; i < size; i++){
-        newArray[i] = items[i]; // Copy each item
+        newArray[i] = lines[i]; // Copy each line
     }
     
-    capacity *= 2;
-    delete [] items;
-    items = newArray;
+    capacity = newCapacity;
+    delete [] lines;
+    lines = newArray;
 }
 
 //--- Definition of isEmpty()
@@ -75,7 +99,32 @@ int Order::getItemCount() const {
 //--- Definition of getItem()
 MenuItem Order::getItem(int i) const {
     assert(i >= 0 && i < size);
-    return items[i];
+    const OrderLine& line = lines[i];
+
+    // Names live in the Menu; only the charged price is kept on the line
+    if (menu != NULL) {
+        MenuItem item = menu->getItemById(line.itemId);
+        if (item.getId() != -1) {
+            item.setPrice(line.unitPrice);
+            return item;
+        }
+    }
+
+    stringstream name;
+    name << "Item #" << line.itemId;
+    return MenuItem(line.itemId, name.str(), "", line.unitPrice);
+}
+
+//--- Definition of getQuantity()
+int Order::getQuantity(int i) const {
+    assert(i >= 0 && i < size);
+    return lines[i].quantity;
+}
+
+//--- Definition of getLine()
+const OrderLine& Order::getLine(int i) const {
+    assert(i >= 0 && i < size);
+    return lines[i];
 }
 
 //--- Definition of setOrderId()
@@ -105,47 +154,104 @@ void Order::setStatus(char status){
 
 //--- Definition of addItem()
 void Order::addItem(const MenuItem& item){
+    addLine(item.getId(), 1, item.getPrice());
+}
+
+//--- Definition of addLine()
+void Order::addLine(int itemId, int quantity, Money unitPrice){
+    // Repeated items share a line as long as the price has not changed
+    for(int i = 0; i < size; i++){
+        if(lines[i].itemId == itemId && lines[i].unitPrice == unitPrice){
+            lines[i].quantity += quantity;
+            return;
+        }
+    }
+
     if(size == capacity)
         resize();
     
-    items[size] = item;
+    lines[size].itemId = itemId;
+    lines[size].quantity = quantity;
+    lines[size].unitPrice = unitPrice;
     size++;
 }
 
 //--- Definition of calculateTotalAmount()
-double Order::calculateTotalAmount() const {
-    double total = 0;
+Money Order::calculateTotalAmount() const {
+    Money total;
     
     for(int i = 0; i < size; i++){
-        total += items[i].getPrice();
+        total += lines[i].unitPrice * lines[i].quantity;
     }
     
     return total;
 }
 
+//--- Definition of stamp()
+void Order::stamp(Stage stage){
+    timestamps[stage] = monotonicNanos();
+}
+
+//--- Definition of getTimestamp()
+long long Order::getTimestamp(Stage stage) const {
+    return timestamps[stage];
+}
+
+//--- Definition of monotonicNanos()
+long long Order::monotonicNanos(){
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 //--- Definition of assignment operator=()
 Order& Order::operator=(const Order& other) {
     if (this != &other) {  // Avoid self-assignment
         // Free existing resources
-        delete[] items;
+        delete[] lines;
 
         // Copy data from the other object
         orderId = other.orderId;
         customerName = other.customerName;
+        menu = other.menu;
         size = other.size;
         capacity = other.capacity;
         status = other.status;
+        memcpy(timestamps, other.timestamps, sizeof(timestamps));
 
-        // Allocate new memory and copy items
-        items = new MenuItem[capacity];
+        // Allocate new memory and copy lines
+        lines = new OrderLine[capacity];
         for (int i = 0; i < size; i++) {
-            items[i] = other.items[i];
+            lines[i] = other.lines[i];
         }
     }
 
     return *this;
 }
 
+//--- Definition of move assignment operator=()
+Order& Order::operator=(Order&& other) noexcept {
+    if (this != &other) {  // Avoid self-assignment
+        // Free existing resources
+        delete[] lines;
+
+        // Take over the data of the other object
+        orderId = other.orderId;
+        customerName = move(other.customerName);
+        menu = other.menu;
+        lines = other.lines;
+        size = other.size;
+        capacity = other.capacity;
+        status = other.status;
+        memcpy(timestamps, other.timestamps, sizeof(timestamps));
+
+        other.lines = NULL;
+        other.size = 0;
+        other.capacity = 0;
+    }
+
+    return *this;
+}
+
 //--- Definition of overloaded operator<<()
 ostream& operator<<(ostream& out, const Order& order){
     out << "Order ID: " << order.orderId << ", Customer: " 
@@ -154,8 +260,12 @@ ostream& operator<<(ostream& out, const Order& order){
 
     // Iterate through all items of an order and display them
     for (int i = 0; i < order.size; i++) {
-        out << "  - " << order.items[i].getName() << " ($" 
-            << order.items[i].getPrice() << ")" << endl;
+        out << "  - ";
+        if (order.lines[i].quantity > 1) {
+            out << order.lines[i].quantity << " x ";
+        }
+        out << order.getItem(i).getName() << " ($" 
+            << order.lines[i].unitPrice << ")" << endl;
     }
 
     out << "Status: " 
@@ -1,18 +1,25 @@
 /*-- Order.h -----------------------------------------------------------------
 
   This header file defines the Order class, which represents a customer's order.
-  An Order consists of a unique ID, customer name, a dynamic list of MenuItems, 
-  the order's status, and methods for managing the order's items and details.
+  An Order consists of a unique ID, customer name, a dynamic list of order 
+  lines, the order's status, and methods for managing the order's items and 
+  details. An order line only records the item's ID, the quantity and the unit
+  price charged; names and descriptions are looked up in the Menu when the 
+  order is displayed or saved, so copying an Order never copies menu text.
   
   Basic operations:
     Constructor:         Constructs an Order with default or specified values.
     Destructor:          Releases dynamically allocated memory.
     Copy constructor:    Creates a deep copy of an Order object.
-    Assignment operator: Assigns the values of one Order to another.
+    Move constructor:    Takes over the lines of another Order without copying.
+    Assignment operator: Assigns the values of one Order to another, by copy 
+                         or by move.
     Accessors:           Retrieve order attributes (ID, customer name, status, items).
     Mutators:            Modify order attributes (ID, customer name, status).
     Item management:     Add items to the order, retrieve items, check item count.
     Calculate total:     Compute the total cost of all items in the order.
+    Timestamps:          Record and read when the order was created, 
+                         enqueued, dequeued and completed.
     Overloaded <<:       Outputs the Order details to an output stream.
 
   Class Invariant:
@@ -20,7 +27,12 @@
     2. Customer name is a non-empty string.
     3. Status is a valid character representing the order state 
        (e.g., 'P' for pending, 'C' for completed).
-    4. Items are stored in a dynamically allocated array, resized as needed.
+    4. Lines are stored in a dynamically allocated array, resized as needed.
+       No two lines have both the same item ID and the same unit price.
+    5. timestamps[stage] is the monotonic time in nanoseconds at which the
+       order reached that stage, or 0 if it was not stamped. Reading the
+       clock is left to the code that takes, queues and completes orders,
+       so constructing and copying Orders stays free of clock reads.
 -----------------------------------------------------------------------------*/
 
 #ifndef ORDER_H
@@ -29,19 +41,39 @@
 using namespace std;
 
 #include "MenuItem.h"
+#include "Menu.h"
+#include "Money.h"
 #include <cassert>
+#include <utility>
+
+/***** Order Line *****/
+struct OrderLine {
+    int itemId;        // ID of the ordered MenuItem
+    int quantity;      // Number of units ordered
+    Money unitPrice;   // Price of one unit when the order was taken
+};
 
 class Order {
 public:
+    /***** Lifecycle Stages *****/
+    enum Stage {
+        CREATED = 0,       // Taken from the customer
+        ENQUEUED = 1,      // Added to an order queue
+        DEQUEUED = 2,      // Taken from the queue for the kitchen
+        COMPLETED = 3,     // Prepared and marked 'C'
+        STAGE_COUNT = 4
+    };
+
     /***** Constructors and Destructor *****/
-    Order(int id = 0, const string& customerName = "");
+    Order(int id = 0, const string& customerName = "", const Menu* menu = NULL);
     /*------------------------------------------------------------------------
       Construct an Order object with default or specified values.
 
-      Precondition:  None.
+      Precondition:  If given, menu outlives the Order and its copies.
       Postcondition: Order is initialized with the specified ID and customer 
-                     name, or default values if not provided. Items array 
-                     is initialized with default capacity.
+                     name, or default values if not provided. Lines array 
+                     is initialized with default capacity. Item names are
+                     resolved through menu.
     ------------------------------------------------------------------------*/
 
     Order(const Order& other);
@@ -53,12 +85,22 @@ public:
                      dynamically allocated memory as the original.
     ------------------------------------------------------------------------*/
 
+    Order(Order&& other) noexcept;
+    /*------------------------------------------------------------------------
+      Move constructor: Take over the lines array of another Order.
+
+      Precondition:  None.
+      Postcondition: A new Order is created with other's values and lines
+                     array. other is left as an empty order with no lines 
+                     array, which is allocated again if items are added.
+    ------------------------------------------------------------------------*/
+
     ~Order();
     /*------------------------------------------------------------------------
-      Destructor: Releases dynamically allocated memory for the items array.
+      Destructor: Releases dynamically allocated memory for the lines array.
 
       Precondition:  None.
-      Postcondition: The memory for the items array is deallocated.
+      Postcondition: The memory for the lines array is deallocated.
     ------------------------------------------------------------------------*/
 
     /***** Accessor Functions *****/
@@ -96,18 +138,37 @@ public:
 
     int getItemCount() const;
     /*------------------------------------------------------------------------
-      Retrieve the number of items in the order.
+      Retrieve the number of lines in the order.
 
       Precondition:  None.
-      Postcondition: Returns the number of items in the order.
+      Postcondition: Returns the number of distinct lines in the order.
     ------------------------------------------------------------------------*/
 
     MenuItem getItem(int i) const;
     /*------------------------------------------------------------------------
-      Retrieve a specific item from the order.
+      Retrieve the item ordered on a specific line.
+
+      Precondition:  0 <= i < size.
+      Postcondition: Returns the MenuItem of line i with its name and 
+                     description taken from the Menu and the price charged
+                     on this order. An item that is no longer on the Menu 
+                     is named "Item #<id>".
+    ------------------------------------------------------------------------*/
+
+    int getQuantity(int i) const;
+    /*------------------------------------------------------------------------
+      Retrieve the quantity ordered on a specific line.
 
       Precondition:  0 <= i < size.
-      Postcondition: Returns the MenuItem at index i.
+      Postcondition: Returns the number of units ordered on line i.
+    ------------------------------------------------------------------------*/
+
+    const OrderLine& getLine(int i) const;
+    /*------------------------------------------------------------------------
+      Retrieve a specific line of the order without resolving its name.
+
+      Precondition:  0 <= i < size.
+      Postcondition: Returns a reference to line i.
     ------------------------------------------------------------------------*/
 
     /***** Mutator Functions *****/
@@ -138,19 +199,59 @@ public:
     /***** Item Management *****/
     void addItem(const MenuItem& item);
     /*------------------------------------------------------------------------
-      Add an item to the order.
+      Add one unit of an item to the order.
 
       Precondition:  None.
-      Postcondition: Adds the specified MenuItem to the order. Resizes the 
-                     items array if necessary.
+      Postcondition: Increments the quantity of the line with the same item 
+                     ID and price, or appends a new line recording the item's
+                     ID and current price. Resizes the lines array if 
+                     necessary.
     ------------------------------------------------------------------------*/
 
-    double calculateTotalAmount() const;
+    void addLine(int itemId, int quantity, Money unitPrice);
+    /*------------------------------------------------------------------------
+      Add units of an item at a recorded price, e.g. when an order is
+      rebuilt from a log.
+
+      Precondition:  quantity > 0.
+      Postcondition: Same as quantity calls to addItem() with an item of
+                     that ID and price; the item need not be on the menu.
+    ------------------------------------------------------------------------*/
+
+    Money calculateTotalAmount() const;
     /*------------------------------------------------------------------------
       Calculate the total cost of all items in the order.
 
       Precondition:  None.
-      Postcondition: Returns the total cost as a double value.
+      Postcondition: Returns the exact total cost.
+    ------------------------------------------------------------------------*/
+
+    /***** Timestamps *****/
+    void stamp(Stage stage);
+    /*------------------------------------------------------------------------
+      Record that the order reached a stage now.
+
+      Precondition:  None.
+      Postcondition: getTimestamp(stage) is the current monotonic time.
+    ------------------------------------------------------------------------*/
+
+    long long getTimestamp(Stage stage) const;
+    /*------------------------------------------------------------------------
+      Retrieve when the order reached a stage.
+
+      Precondition:  None.
+      Postcondition: Returns the monotonic time in nanoseconds, comparable
+                     only with other timestamps of this run, or 0 if the
+                     stage was not stamped.
+    ------------------------------------------------------------------------*/
+
+    static long long monotonicNanos();
+    /*------------------------------------------------------------------------
+      Read the monotonic clock used for timestamps.
+
+      Precondition:  None.
+      Postcondition: Returns nanoseconds from an arbitrary fixed point; the
+                     value never decreases, even if the wall clock changes.
     ------------------------------------------------------------------------*/
 
     /***** Overloaded Operators *****/
@@ -163,6 +264,16 @@ public:
                      dynamically allocated memory of the other Order.
     ------------------------------------------------------------------------*/
 
+    Order& operator=(Order&& other) noexcept;
+    /*------------------------------------------------------------------------
+      Move the values of one Order into another.
+
+      Precondition:  None.
+      Postcondition: The current Order releases its lines array and takes 
+                     over other's values and lines array. other is left as
+                     an empty order.
+    ------------------------------------------------------------------------*/
+
     friend ostream& operator<<(ostream& out, const Order& order);
     /*------------------------------------------------------------------------
       Overload the << operator to output an Order's details.
@@ -175,18 +286,21 @@ public:
 private:
     int orderId;               // Unique ID for the order
     string customerName;       // Name of the customer who placed the order
-    MenuItem* items;           // Dynamic array of items in the order
-    int size;                  // Current number of items in the order
+    const Menu* menu;          // Menu used to resolve item names, may be NULL
+    OrderLine* lines;          // Dynamic array of lines in the order
+    int size;                  // Current number of lines in the order
     int capacity;              // Maximum capacity of the dynamic array
     char status;               // Status of the order ('P' = Pending, 'C' = Completed)
+    long long timestamps[STAGE_COUNT]; // When each stage was reached
 
     void resize();
     /*------------------------------------------------------------------------
-      Resize the dynamic array of items when it reaches capacity.
+      Resize the dynamic array of lines when it reaches capacity.
 
       Precondition:  None.
-      Postcondition: The array's capacity is doubled, and existing items
-                     are copied to the new array.
+      Postcondition: The array's capacity is doubled, and existing lines
+                     are copied to the new array. An Order without an array
+                     (after being moved from) gets the default capacity.
     ------------------------------------------------------------------------*/
 };
 
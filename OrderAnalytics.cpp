@@ -0,0 +1,317 @@
+/*-- OrderAnalytics.cpp ------------------------------------------------------
+              This file implements OrderAnalytics member functions.
+--------------------------------------------------------------------------*/
+
+#include "OrderAnalytics.h"
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+#include <unordered_map>
+
+static const size_t ROWS_PER_THREAD = 1 << 16; // Fewer are quicker on one thread
+
+// Calls body(worker, begin, end) for `workers` contiguous ranges of
+// [0, count), each on its own thread, and waits for all of them
+template <typename Body>
+static void forEachRange(size_t count, int workers, Body body){
+    size_t step = count / workers + 1;
+    vector<thread> pool;
+    for (int worker = 1; worker < workers; worker++) {
+        size_t begin = min(count, step * worker);
+        size_t end = min(count, begin + step);
+        pool.push_back(thread(body, worker, begin, end));
+    }
+    body(0, 0, min(count, step)); // The calling thread takes the first range
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+}
+
+//--- Definition of OrderAnalytics constructor
+OrderAnalytics::OrderAnalytics(int threads) : minItemId(0), maxItemId(0) {
+    if (threads <= 0)
+        threads = (int)thread::hardware_concurrency();
+    this->threads = threads > 0 ? threads : 1; // Hardware concurrency may be unknown
+}
+
+//--- Definition of addOrder()
+void OrderAnalytics::addOrder(const Order& order, long long timestamp){
+    Money total;
+    int units = 0;
+
+    for (int i = 0; i < order.getItemCount(); i++) {
+        const OrderLine& line = order.getLine(i);
+        if (itemIds.empty()) {
+            minItemId = maxItemId = line.itemId;
+        } else {
+            minItemId = min(minItemId, line.itemId);
+            maxItemId = max(maxItemId, line.itemId);
+        }
+
+        Money lineTotal = line.unitPrice * line.quantity;
+        orderIds.push_back(order.getOrderId());
+        itemIds.push_back(line.itemId);
+        quantities.push_back(line.quantity);
+        unitPrices.push_back(line.unitPrice);
+        lineTotals.push_back(lineTotal);
+        timestamps.push_back(timestamp);
+
+        total += lineTotal;
+        units += line.quantity;
+    }
+
+    orderTotals.push_back(total);
+    orderUnits.push_back(units);
+}
+
+//--- Definition of loadFrom()
+void OrderAnalytics::loadFrom(const CompletedOrderStack& completed){
+    TRACE_SPAN("OrderAnalytics::loadFrom");
+    clear();
+
+    // Completion stamps are monotonic; read both clocks once to move them
+    // onto the wall clock
+    long long wallNow = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::system_clock::now().time_since_epoch()).count();
+    long long wallOffset = wallNow - Order::monotonicNanos();
+
+    // Size the columns once; about three lines per order to start with
+    size_t orders = completed.size();
+    orderTotals.reserve(orders);
+    orderUnits.reserve(orders);
+    orderIds.reserve(orders * 3);
+    itemIds.reserve(orders * 3);
+    quantities.reserve(orders * 3);
+    unitPrices.reserve(orders * 3);
+    lineTotals.reserve(orders * 3);
+    timestamps.reserve(orders * 3);
+
+    CompletedOrderStack::const_reverse_iterator it;
+    for (it = completed.rbegin(); it != completed.rend(); ++it) {
+        long long stamp = it->getTimestamp(Order::COMPLETED);
+        long long completedAt = stamp != 0 ? stamp + wallOffset : wallNow;
+        addOrder(*it, completedAt / 1000000000LL);
+    }
+}
+
+//--- Definition of clear()
+void OrderAnalytics::clear(){
+    orderIds.clear();
+    itemIds.clear();
+    quantities.clear();
+    unitPrices.clear();
+    lineTotals.clear();
+    timestamps.clear();
+    orderTotals.clear();
+    orderUnits.clear();
+    minItemId = maxItemId = 0;
+}
+
+//--- Definition of orderCount()
+int OrderAnalytics::orderCount() const {
+    return (int)orderTotals.size();
+}
+
+//--- Definition of lineCount()
+int OrderAnalytics::lineCount() const {
+    return (int)lineTotals.size();
+}
+
+//--- Definition of workersFor()
+int OrderAnalytics::workersFor(size_t rows) const {
+    size_t workers = rows / ROWS_PER_THREAD;
+    if (workers < 1)
+        return 1;
+    return workers < (size_t)threads ? (int)workers : threads;
+}
+
+//--- Definition of calculateTotalRevenue()
+Money OrderAnalytics::calculateTotalRevenue() const {
+    int workers = workersFor(lineTotals.size());
+    vector<Money> partials(workers);
+    vector<char> valid(workers);
+
+    // Money::sum adds each range with a vectorizable loop and checks for
+    // overflow once per block
+    forEachRange(lineTotals.size(), workers, [&](int worker, size_t begin, size_t end){
+        valid[worker] = Money::sum(lineTotals.data() + begin, end - begin, partials[worker]);
+    });
+
+    Money total;
+    for (int i = 0; i < workers; i++) {
+        if (!valid[i] || !Money::addChecked(total, partials[i], total)) {
+            cerr << "Error: Revenue is out of range" << endl;
+            return Money();
+        }
+    }
+    return total;
+}
+
+//--- Definition of revenueBetween()
+Money OrderAnalytics::revenueBetween(long long from, long long to) const {
+    int workers = workersFor(lineTotals.size());
+    vector<long long> partials(workers);
+
+    forEachRange(lineTotals.size(), workers, [&](int worker, size_t begin, size_t end){
+        // Select with a mask instead of a branch, so the loop vectorizes
+        long long sum = 0;
+        const long long* time = timestamps.data();
+        const Money* amount = lineTotals.data();
+        for (size_t i = begin; i < end; i++) {
+            long long inRange = (time[i] >= from) & (time[i] < to);
+            sum += amount[i].getCents() & -inRange;
+        }
+        partials[worker] = sum;
+    });
+
+    long long total = 0;
+    for (int i = 0; i < workers; i++) {
+        total += partials[i];
+    }
+    return Money(total);
+}
+
+//--- Definition of averageOrderValue()
+Money OrderAnalytics::averageOrderValue() const {
+    long long orders = (long long)orderTotals.size();
+    if (orders == 0)
+        return Money();
+
+    Money total;
+    if (!Money::sum(orderTotals.data(), orderTotals.size(), total)) {
+        cerr << "Error: Revenue is out of range" << endl;
+        return Money();
+    }
+
+    // Round half up, away from zero for refunds
+    long long cents = total.getCents();
+    long long half = cents < 0 ? -(orders / 2) : orders / 2;
+    return Money((cents + half) / orders);
+}
+
+//--- Definition of salesByItem()
+vector<OrderAnalytics::ItemSales> OrderAnalytics::salesByItem() const {
+    vector<ItemSales> sales;
+    if (itemIds.empty())
+        return sales;
+
+    size_t range = (size_t)((long long)maxItemId - minItemId + 1);
+    int workers = workersFor(itemIds.size());
+
+    if (range <= max(itemIds.size(), ROWS_PER_THREAD)) {
+        // Dense IDs: each thread adds into its own arrays indexed by ID
+        vector<vector<long long>> quantity(workers), cents(workers);
+        forEachRange(itemIds.size(), workers, [&](int worker, size_t begin, size_t end){
+            vector<long long>& q = quantity[worker];
+            vector<long long>& c = cents[worker];
+            q.assign(range, 0);
+            c.assign(range, 0);
+            for (size_t i = begin; i < end; i++) {
+                size_t slot = itemIds[i] - minItemId;
+                q[slot] += quantities[i];
+                c[slot] += lineTotals[i].getCents();
+            }
+        });
+
+        for (int worker = 1; worker < workers; worker++) {
+            for (size_t slot = 0; slot < range; slot++) {
+                quantity[0][slot] += quantity[worker][slot];
+                cents[0][slot] += cents[worker][slot];
+            }
+        }
+        for (size_t slot = 0; slot < range; slot++) {
+            if (quantity[0][slot] != 0 || cents[0][slot] != 0) {
+                ItemSales entry = { minItemId + (int)slot, quantity[0][slot],
+                                    Money(cents[0][slot]) };
+                sales.push_back(entry);
+            }
+        }
+        return sales;
+    }
+
+    // Sparse IDs: a hash table per thread
+    vector<unordered_map<int, ItemSales>> groups(workers);
+    forEachRange(itemIds.size(), workers, [&](int worker, size_t begin, size_t end){
+        unordered_map<int, ItemSales>& group = groups[worker];
+        for (size_t i = begin; i < end; i++) {
+            ItemSales& entry = group[itemIds[i]];
+            entry.itemId = itemIds[i];
+            entry.quantity += quantities[i];
+            entry.revenue += lineTotals[i];
+        }
+    });
+
+    for (int worker = 1; worker < workers; worker++) {
+        unordered_map<int, ItemSales>::const_iterator it;
+        for (it = groups[worker].begin(); it != groups[worker].end(); ++it) {
+            ItemSales& entry = groups[0][it->first];
+            entry.itemId = it->first;
+            entry.quantity += it->second.quantity;
+            entry.revenue += it->second.revenue;
+        }
+    }
+    for (unordered_map<int, ItemSales>::const_iterator it = groups[0].begin();
+         it != groups[0].end(); ++it) {
+        sales.push_back(it->second);
+    }
+    sort(sales.begin(), sales.end(), [](const ItemSales& a, const ItemSales& b){
+        return a.itemId < b.itemId;
+    });
+    return sales;
+}
+
+//--- Definition of orderSizeHistogram()
+vector<long long> OrderAnalytics::orderSizeHistogram(int maxUnits) const {
+    int workers = workersFor(orderUnits.size());
+    vector<vector<long long>> partials(workers);
+
+    forEachRange(orderUnits.size(), workers, [&](int worker, size_t begin, size_t end){
+        vector<long long>& counts = partials[worker];
+        counts.assign(maxUnits + 1, 0);
+        for (size_t i = begin; i < end; i++) {
+            counts[min(orderUnits[i], maxUnits)]++; // Larger orders share the last bucket
+        }
+    });
+
+    for (int worker = 1; worker < workers; worker++) {
+        for (int units = 0; units <= maxUnits; units++) {
+            partials[0][units] += partials[worker][units];
+        }
+    }
+    return partials[0];
+}
+
+//--- Definition of printReport()
+void OrderAnalytics::printReport(ostream& out, const Menu& menu) const {
+    const int MAX_UNITS = 10;
+
+    out << "--- Sales Report ---" << endl;
+    out << "Orders: " << orderCount() << ", revenue: $" << calculateTotalRevenue()
+        << ", average order value: $" << averageOrderValue() << endl;
+
+    // Best sellers first
+    vector<ItemSales> sales = salesByItem();
+    sort(sales.begin(), sales.end(), [](const ItemSales& a, const ItemSales& b){
+        return b.revenue < a.revenue || (a.revenue == b.revenue && a.itemId < b.itemId);
+    });
+
+    out << left << setw(8) << "ID" << setw(24) << "Item" << right
+        << setw(10) << "Quantity" << setw(14) << "Revenue" << endl;
+    for (size_t i = 0; i < sales.size(); i++) {
+        MenuItem item = menu.getItemById(sales[i].itemId);
+        string_view name = item.getId() == -1 ? "(deleted item)" : item.getName();
+        out << left << setw(8) << sales[i].itemId << setw(24) << name << right
+            << setw(10) << sales[i].quantity
+            << setw(14) << "$" + sales[i].revenue.toString() << endl;
+    }
+
+    out << "Order sizes:" << endl;
+    vector<long long> sizes = orderSizeHistogram(MAX_UNITS);
+    for (int units = 1; units <= MAX_UNITS; units++) {
+        out << setw(4) << units << (units == MAX_UNITS ? "+" : " ") << " units: "
+            << sizes[units] << endl;
+    }
+    out.unsetf(ios::adjustfield); // Restore the default alignment
+}
@@ -0,0 +1,190 @@
+/*-- OrderAnalytics.h --------------------------------------------------------
+
+  This header file defines the OrderAnalytics class, a column store of
+  completed orders for sales reports. Instead of one object per order it
+  keeps one array per field (structure of arrays):
+
+    per order line:  order ID, item ID, quantity, unit price, line total
+                     (quantity x unit price) and timestamp
+    per order:       total and number of units
+
+  Each report reads only the columns it needs, front to back. The kernels
+  are plain loops without branches in their bodies, so the compiler can
+  vectorize them, and large columns are split into contiguous ranges that
+  are aggregated on several threads, each into its own partial result,
+  and then combined. Amounts stay in integer cents throughout, so the
+  results equal the totals of the CompletedOrderStack exactly.
+
+  Basic operations:
+    Constructor:        Creates an empty store using a number of threads.
+    addOrder:           Appends the lines of one order.
+    loadFrom:           Replaces the contents with a CompletedOrderStack.
+    clear:              Removes every order.
+    Accessors:          Order and line counts.
+    calculateTotalRevenue: Sum of the line totals.
+    revenueBetween:     Sum of the line totals in a time range.
+    averageOrderValue:  Revenue divided by the number of orders.
+    salesByItem:        Quantity sold and revenue per item ID.
+    orderSizeHistogram: Number of orders per count of units.
+    printReport:        Outputs the sales report.
+
+  Class Invariant:
+    1. The line columns all have lineCount() entries and the order
+       columns orderCount() entries; the lines of an order are adjacent.
+    2. lineTotals[i] == unitPrices[i] * quantities[i], and orderTotals
+       holds the sum of the line totals of each order.
+    3. If there are lines, every item ID is in [minItemId, maxItemId].
+-----------------------------------------------------------------------------*/
+
+#ifndef ORDERANALYTICS_H
+#define ORDERANALYTICS_H
+
+#include "Menu.h"
+#include "Money.h"
+#include "Order.h"
+#include "CompletedOrderStack.h"
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+class OrderAnalytics {
+public:
+    /***** Item Totals *****/
+    struct ItemSales {
+        int itemId;
+        long long quantity;  // Units sold
+        Money revenue;       // Sum of their line totals
+    };
+
+    /***** Constructor *****/
+    OrderAnalytics(int threads = 0);
+    /*------------------------------------------------------------------------
+      Construct an empty store.
+
+      Precondition:  None.
+      Postcondition: Reports use up to `threads` threads (one per hardware
+                     thread if 0); small stores are aggregated on one.
+    ------------------------------------------------------------------------*/
+
+    /***** Loading *****/
+    void addOrder(const Order& order, long long timestamp);
+    /*------------------------------------------------------------------------
+      Append an order.
+
+      Precondition:  timestamp is the time the order was completed, in
+                     seconds since the epoch.
+      Postcondition: One row per order line is appended to the line
+                     columns and one row to the order columns.
+    ------------------------------------------------------------------------*/
+
+    void loadFrom(const CompletedOrderStack& completed);
+    /*------------------------------------------------------------------------
+      Replace the contents with the orders of a stack.
+
+      Precondition:  None.
+      Postcondition: The store holds the orders of completed, oldest first,
+                     each timestamped with its COMPLETED stamp in seconds
+                     since the epoch. Orders never stamped in this run,
+                     such as those read back from a file or the log, are
+                     timestamped with the current time.
+    ------------------------------------------------------------------------*/
+
+    void clear();
+    /*------------------------------------------------------------------------
+      Remove every order.
+
+      Precondition:  None.
+      Postcondition: orderCount() and lineCount() are 0.
+    ------------------------------------------------------------------------*/
+
+    /***** Accessors *****/
+    int orderCount() const;
+    int lineCount() const;
+
+    /***** Reports *****/
+    Money calculateTotalRevenue() const;
+    /*------------------------------------------------------------------------
+      Calculate the revenue of every order.
+
+      Precondition:  None.
+      Postcondition: Returns the exact sum of the line totals, or zero
+                     after reporting an error if it is out of range.
+    ------------------------------------------------------------------------*/
+
+    Money revenueBetween(long long from, long long to) const;
+    /*------------------------------------------------------------------------
+      Calculate the revenue of a period.
+
+      Precondition:  from <= to, in the units of the timestamps.
+      Postcondition: Returns the sum of the line totals with a timestamp
+                     in [from, to).
+    ------------------------------------------------------------------------*/
+
+    Money averageOrderValue() const;
+    /*------------------------------------------------------------------------
+      Calculate the average order value.
+
+      Precondition:  None.
+      Postcondition: Returns the revenue divided by the number of orders,
+                     rounded half up to the cent, or zero with no orders.
+    ------------------------------------------------------------------------*/
+
+    vector<ItemSales> salesByItem() const;
+    /*------------------------------------------------------------------------
+      Group the sales by item.
+
+      Precondition:  None.
+      Postcondition: Returns one entry per item ID sold, sorted by ID; the
+                     revenues add up to calculateTotalRevenue().
+    ------------------------------------------------------------------------*/
+
+    vector<long long> orderSizeHistogram(int maxUnits) const;
+    /*------------------------------------------------------------------------
+      Count the orders by number of units.
+
+      Precondition:  maxUnits >= 1.
+      Postcondition: Returns maxUnits + 1 counts: entry n is the number of
+                     orders of n units, and the last entry also counts the
+                     larger orders.
+    ------------------------------------------------------------------------*/
+
+    void printReport(ostream& out, const Menu& menu) const;
+    /*------------------------------------------------------------------------
+      Output the sales report.
+
+      Precondition:  ostream out is open.
+      Postcondition: Outputs the order count, revenue, average order value,
+                     the quantity and revenue of each item (best selling
+                     first, named from menu) and the order size histogram.
+    ------------------------------------------------------------------------*/
+
+private:
+    int threads;                 // Most threads a report may use
+
+    // Line columns
+    vector<int> orderIds;
+    vector<int> itemIds;
+    vector<int> quantities;
+    vector<Money> unitPrices;
+    vector<Money> lineTotals;
+    vector<long long> timestamps;
+
+    // Order columns
+    vector<Money> orderTotals;
+    vector<int> orderUnits;
+
+    int minItemId;
+    int maxItemId;
+
+    int workersFor(size_t rows) const;
+    /*------------------------------------------------------------------------
+      Choose how many threads aggregate a column.
+
+      Precondition:  None.
+      Postcondition: Returns between 1 and `threads`, so that each thread
+                     gets enough rows to be worth starting.
+    ------------------------------------------------------------------------*/
+};
+
+#endif // ORDERANALYTICS_H
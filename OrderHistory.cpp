@@ -0,0 +1,412 @@
+/*-- OrderHistory.cpp --------------------------------------------------------
+              This file implements OrderHistory member functions.
+--------------------------------------------------------------------------*/
+
+#include "OrderHistory.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <new>
+#include <thread>
+
+static const size_t MIN_CHUNK = 1 << 20;   // Smaller chunks cost more than they save
+static const string_view TRAILER = "Total revenue is: $";
+static const string_view DAILY_PREFIX = "completed_orders (";
+
+/***** Chunk *****/
+struct OrderHistory::Chunk {
+    int file;                        // Index in `files`
+    const char* begin;
+    const char* end;
+
+    vector<OrderView> orders;        // firstLine relative to `lines`
+    vector<LineView> lines;
+    Money revenue;
+    Money trailer;
+    bool hasTrailer;
+    int lineCount;                   // Text lines, for error line numbers
+
+    struct Skipped {
+        int line;                    // Line number within the chunk
+        const char* problem;
+        string_view text;
+    };
+    vector<Skipped> skipped;
+};
+
+// Splits the quoted item list into lines, merging repeated units
+static bool parseItems(string_view list, vector<OrderHistory::LineView>& lines){
+    size_t position = 0;
+    while (position < list.size()) {
+        // Names may hold '&' or ':', so the entry ends at the first colon
+        // followed by a valid price
+        size_t colon = list.find(':', position);
+        OrderHistory::LineView line;
+        line.quantity = 1;
+        size_t next = string_view::npos;
+        while (colon != string_view::npos) {
+            next = list.find('&', colon + 1);
+            size_t priceEnd = next == string_view::npos ? list.size() : next;
+            if (Money::parse(list.data() + colon + 1, list.data() + priceEnd, line.unitPrice))
+                break;
+            colon = list.find(':', colon + 1);
+        }
+        if (colon == string_view::npos)
+            return false;
+
+        line.name = list.substr(position, colon - position);
+        OrderHistory::LineView* previous = lines.empty() ? NULL : &lines.back();
+        if (previous && previous->name == line.name && previous->unitPrice == line.unitPrice)
+            previous->quantity++;
+        else
+            lines.push_back(line);
+
+        position = next == string_view::npos ? list.size() : next + 1;
+    }
+    return true;
+}
+
+//--- Definition of OrderHistory constructor
+OrderHistory::OrderHistory() : errors(0) {
+}
+
+//--- Definition of OrderHistory destructor
+OrderHistory::~OrderHistory(){
+    clear();
+}
+
+//--- Definition of load()
+bool OrderHistory::load(const vector<string>& filenames, int threads){
+    TRACE_SPAN("OrderHistory::load");
+    clear();
+
+    if (threads <= 0)
+        threads = (int)thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1; // Hardware concurrency is unknown
+
+    // Map every file first; the chunks of all of them share the threads
+    bool allOpened = true;
+    size_t totalBytes = 0;
+    for (size_t i = 0; i < filenames.size(); i++) {
+        MappedFile* contents = new(nothrow) MappedFile();
+        if (!contents) {
+            METRIC_INC(ALLOCATION_FAILURES);
+            cerr << "Memory Allocation Failed" << endl;
+            return false;
+        }
+        if (!contents->open(filenames[i])) {
+            cerr << "Error: Could not open file " << filenames[i] << endl;
+            delete contents;
+            allOpened = false;
+            continue;
+        }
+
+        File file = { filenames[i], contents, Money(), Money(), false };
+        files.push_back(file);
+        totalBytes += contents->size();
+    }
+
+    // Cut each file at the first newline after every chunkSize bytes,
+    // aiming at a few chunks per thread for balance
+    size_t chunkSize = max(MIN_CHUNK, totalBytes / (threads * 4) + 1);
+    vector<Chunk> chunks;
+    for (size_t i = 0; i < files.size(); i++) {
+        const char* position = files[i].contents->data();
+        const char* end = position + files[i].contents->size();
+        while (position < end) {
+            const char* cut = end;
+            if ((size_t)(end - position) > chunkSize) {
+                const char* newline = (const char*)memchr(position + chunkSize, '\n',
+                                                          end - position - chunkSize);
+                cut = newline ? newline + 1 : end;
+            }
+
+            chunks.push_back(Chunk());
+            chunks.back().file = (int)i;
+            chunks.back().begin = position;
+            chunks.back().end = cut;
+            position = cut;
+        }
+    }
+
+    // Workers take the next unparsed chunk until none are left
+    atomic<size_t> nextChunk(0);
+    auto work = [&chunks, &nextChunk]{
+        size_t index;
+        while ((index = nextChunk.fetch_add(1)) < chunks.size()) {
+            parseChunk(chunks[index]);
+        }
+    };
+
+    int workerCount = (int)min((size_t)threads, chunks.size());
+    vector<thread> workers;
+    for (int i = 1; i < workerCount; i++) {
+        workers.push_back(thread(work));
+    }
+    work(); // The calling thread parses too
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+
+    // Join the chunks in file order, numbering the skipped lines
+    size_t orderTotal = 0, lineTotal = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        orderTotal += chunks[i].orders.size();
+        lineTotal += chunks[i].lines.size();
+    }
+    orders.reserve(orderTotal);
+    lines.reserve(lineTotal);
+
+    int lineBase = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        Chunk& chunk = chunks[i];
+        File& file = files[chunk.file];
+        if (i > 0 && chunks[i - 1].file != chunk.file)
+            lineBase = 0;
+
+        for (size_t j = 0; j < chunk.skipped.size(); j++) {
+            cerr << "Error: Skipping line " << lineBase + chunk.skipped[j].line
+                 << " of " << file.name << " (" << chunk.skipped[j].problem << "): "
+                 << chunk.skipped[j].text << endl;
+        }
+        errors += (int)chunk.skipped.size();
+        lineBase += chunk.lineCount;
+
+        int lineOffset = (int)lines.size();
+        for (size_t j = 0; j < chunk.orders.size(); j++) {
+            orders.push_back(chunk.orders[j]);
+            orders.back().firstLine += lineOffset;
+        }
+        lines.insert(lines.end(), chunk.lines.begin(), chunk.lines.end());
+        vector<OrderView>().swap(chunk.orders); // Keeps the peak near one copy
+        vector<LineView>().swap(chunk.lines);
+
+        file.revenue += chunk.revenue;
+        if (chunk.hasTrailer) { // The last trailer of the file counts
+            file.trailer = chunk.trailer;
+            file.hasTrailer = true;
+        }
+    }
+
+    return allOpened;
+}
+
+//--- Definition of parseChunk()
+void OrderHistory::parseChunk(Chunk& chunk){
+    chunk.hasTrailer = false;
+    chunk.lineCount = 0;
+
+    // About 50 bytes per order; reserving saves most of the regrowth
+    size_t expected = (chunk.end - chunk.begin) / 48 + 1;
+    chunk.orders.reserve(expected);
+    chunk.lines.reserve(expected * 2);
+
+    const char* position = chunk.begin;
+    while (position < chunk.end) {
+        const char* newline = (const char*)memchr(position, '\n', chunk.end - position);
+        const char* lineEnd = newline ? newline : chunk.end;
+        string_view line(position, lineEnd - position);
+        position = newline ? newline + 1 : chunk.end;
+        chunk.lineCount++;
+
+        if (!line.empty() && line.back() == '\r') // Windows line endings
+            line.remove_suffix(1);
+        if (line.find_first_not_of(" \t") == string_view::npos)
+            continue; // Blank line
+
+        if (line.substr(0, TRAILER.size()) == TRAILER) {
+            if (Money::parse(line.data() + TRAILER.size(), line.data() + line.size(),
+                             chunk.trailer)) {
+                chunk.hasTrailer = true;
+            } else {
+                chunk.skipped.push_back({ chunk.lineCount, "invalid revenue", line });
+            }
+            continue;
+        }
+
+        // id, then everything up to the last comma, then the total
+        size_t idEnd = line.find(',');
+        size_t totalStart = line.rfind(',');
+        const char* problem = NULL;
+        OrderView order;
+        order.file = chunk.file;
+        order.firstLine = (int)chunk.lines.size();
+        order.lineCount = 0;
+
+        if (idEnd == string_view::npos || idEnd == totalStart) {
+            problem = "expected id,customer,\"items\",total";
+        } else {
+            from_chars_result parsed = from_chars(line.data(), line.data() + idEnd,
+                                                  order.orderId);
+            if (parsed.ec != errc() || parsed.ptr != line.data() + idEnd)
+                problem = "invalid order ID";
+            else if (!Money::parse(line.data() + totalStart + 1,
+                                   line.data() + line.size(), order.total))
+                problem = "invalid total";
+        }
+
+        // The item list is the quoted field before the total; item names
+        // hold no commas, so it starts after the last comma before it
+        string_view middle;
+        size_t listComma = string_view::npos;
+        if (!problem) {
+            middle = line.substr(idEnd + 1, totalStart - idEnd - 1);
+            listComma = middle.rfind(',');
+            if (listComma == string_view::npos || middle.size() < listComma + 3
+                || middle[listComma + 1] != '"' || middle.back() != '"')
+                problem = "expected a quoted item list";
+        }
+
+        if (!problem) {
+            order.customer = middle.substr(0, listComma);
+            if (order.customer.size() >= 2 && order.customer.front() == '"'
+                && order.customer.back() == '"')
+                order.customer = order.customer.substr(1, order.customer.size() - 2);
+
+            string_view list = middle.substr(listComma + 2, middle.size() - listComma - 3);
+            if (!parseItems(list, chunk.lines)) {
+                chunk.lines.resize(order.firstLine);
+                problem = "invalid item entry";
+            }
+        }
+
+        if (problem) {
+            chunk.skipped.push_back({ chunk.lineCount, problem, line });
+            continue;
+        }
+
+        order.lineCount = (int)chunk.lines.size() - order.firstLine;
+        chunk.orders.push_back(order);
+        chunk.revenue += order.total;
+    }
+}
+
+// Reads the date of a daily file name as year * 10000 + month * 100 + day.
+// Months and days are not zero padded ("2024-11-5"), so names do not sort
+// by date as text; names without a date sort after every dated one.
+static long long dailyFileDate(string_view name){
+    const char* position = name.data() + DAILY_PREFIX.size();
+    const char* end = name.data() + name.size();
+    int parts[3] = {};
+    for (int i = 0; i < 3; i++) {
+        from_chars_result parsed = from_chars(position, end, parts[i]);
+        char separator = i < 2 ? '-' : ')';
+        if (parsed.ec != errc() || parsed.ptr == end || *parsed.ptr != separator)
+            return LLONG_MAX;
+        position = parsed.ptr + 1;
+    }
+    return parts[0] * 10000LL + parts[1] * 100 + parts[2];
+}
+
+//--- Definition of findDailyFiles()
+vector<string> OrderHistory::findDailyFiles(const string& directory){
+    vector<pair<long long, string> > dated;
+    error_code error;
+    filesystem::directory_iterator it(directory, error), end;
+
+    for (; !error && it != end; it.increment(error)) {
+        string name = it->path().filename().string();
+        if (name.compare(0, DAILY_PREFIX.size(), DAILY_PREFIX) == 0
+            && name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0)
+            dated.push_back(make_pair(dailyFileDate(name), it->path().string()));
+    }
+
+    // A directory lists them in any order; the path breaks ties
+    sort(dated.begin(), dated.end());
+    vector<string> found;
+    found.reserve(dated.size());
+    for (size_t i = 0; i < dated.size(); i++) {
+        found.push_back(move(dated[i].second));
+    }
+    return found;
+}
+
+//--- Definition of clear()
+void OrderHistory::clear(){
+    orders.clear();
+    lines.clear();
+    for (size_t i = 0; i < files.size(); i++) {
+        delete files[i].contents;
+    }
+    files.clear();
+    errors = 0;
+}
+
+//--- Definition of size()
+int OrderHistory::size() const {
+    return (int)orders.size();
+}
+
+//--- Definition of getOrder()
+const OrderHistory::OrderView& OrderHistory::getOrder(int index) const {
+    assert(index >= 0 && index < (int)orders.size());
+    return orders[index];
+}
+
+//--- Definition of getLine()
+const OrderHistory::LineView& OrderHistory::getLine(int index) const {
+    assert(index >= 0 && index < (int)lines.size());
+    return lines[index];
+}
+
+//--- Definition of fileCount()
+int OrderHistory::fileCount() const {
+    return (int)files.size();
+}
+
+//--- Definition of getFileName()
+const string& OrderHistory::getFileName(int file) const {
+    assert(file >= 0 && file < (int)files.size());
+    return files[file].name;
+}
+
+//--- Definition of getFileRevenue()
+Money OrderHistory::getFileRevenue(int file) const {
+    assert(file >= 0 && file < (int)files.size());
+    return files[file].revenue;
+}
+
+//--- Definition of trailerMatches()
+bool OrderHistory::trailerMatches(int file) const {
+    assert(file >= 0 && file < (int)files.size());
+    return files[file].hasTrailer && files[file].trailer == files[file].revenue;
+}
+
+//--- Definition of getErrorCount()
+int OrderHistory::getErrorCount() const {
+    return errors;
+}
+
+//--- Definition of calculateTotalRevenue()
+Money OrderHistory::calculateTotalRevenue() const {
+    Money total;
+    for (size_t i = 0; i < files.size(); i++) {
+        total += files[i].revenue;
+    }
+    return total;
+}
+
+//--- Definition of printSummary()
+void OrderHistory::printSummary(ostream& out) const {
+    out << "Files: " << files.size() << ", orders: " << orders.size()
+        << ", item lines: " << lines.size() << ", skipped lines: " << errors << endl;
+    out << "Total revenue: $" << calculateTotalRevenue() << endl;
+
+    for (size_t i = 0; i < files.size(); i++) {
+        if (trailerMatches((int)i))
+            continue;
+        out << "Warning: " << files[i].name;
+        if (files[i].hasTrailer)
+            out << " records revenue $" << files[i].trailer << " but its orders total $";
+        else
+            out << " has no revenue line; its orders total $";
+        out << files[i].revenue << endl;
+    }
+}
@@ -0,0 +1,204 @@
+/*-- OrderHistory.h ----------------------------------------------------------
+
+  This header file defines the OrderHistory class, a read-only index of
+  completed orders files (`completed_orders (Y-M-D).txt`) as written by
+  CompletedOrderStack::saveToFile and appendToFile. Each line of such a
+  file is
+
+      id,customer,"Name:price&Name:price&...",total
+
+  with one Name:price entry per unit sold, and the file ends with a
+  "Total revenue is: $" trailer.
+
+  The files are memory-mapped and cut into chunks at line boundaries; the
+  chunks of all the files are parsed in parallel by a pool of threads and
+  the results joined in file order. Orders are kept as lightweight views:
+  customer and item names are string_views into the mapped files, so
+  loading copies no text. The files do not record item IDs, so the views
+  are not turned back into Order objects, which need a Menu.
+
+  Quoted fields: the item list is quoted, and the customer may be too. A
+  field ends at the comma after its closing quote, so customers may contain
+  commas. Menu item names cannot hold commas or newlines, so the item list
+  is the last quoted field and every newline ends an order.
+
+  Basic operations:
+    Constructor:       Creates an empty history.
+    Destructor:        Unmaps the files.
+    load:              Maps and parses a list of files in parallel.
+    findDailyFiles:    Lists the completed orders files of a directory.
+    clear:             Releases every file and order.
+    Accessors:         Orders, their item lines, and per-file totals.
+    calculateTotalRevenue: Sum of the totals of every order loaded.
+    printSummary:      Outputs counts, revenue and trailer mismatches.
+
+  Class Invariant:
+    1. `orders` holds the orders of every file in file order, then line
+       order; the lines of order i are lines[orders[i].firstLine] onward.
+    2. Every string_view points into a file in `files`, which stays mapped
+       until clear() or destruction.
+    3. Consecutive entries with the same name and price in a file line are
+       one LineView with their count as quantity.
+-----------------------------------------------------------------------------*/
+
+#ifndef ORDERHISTORY_H
+#define ORDERHISTORY_H
+
+#include "MappedFile.h"
+#include "Money.h"
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+class OrderHistory {
+public:
+    /***** Views *****/
+    struct LineView {
+        string_view name;  // Item name, inside the mapped file
+        Money unitPrice;   // Price of one unit as saved
+        int quantity;      // Units sold at that price
+    };
+
+    struct OrderView {
+        int orderId;
+        string_view customer;  // Without surrounding quotes
+        Money total;           // Total as saved in the file
+        int file;              // Index of the file the order came from
+        int firstLine;         // Index of its first LineView
+        int lineCount;         // Number of LineViews
+    };
+
+    /***** Constructor and Destructor *****/
+    OrderHistory();
+    /*------------------------------------------------------------------------
+      Construct an empty history.
+
+      Precondition:  None.
+      Postcondition: size() and fileCount() are 0.
+    ------------------------------------------------------------------------*/
+
+    ~OrderHistory();
+    /*------------------------------------------------------------------------
+      Destructor: Unmaps the files.
+
+      Precondition:  None.
+      Postcondition: Views obtained from the history are no longer valid.
+    ------------------------------------------------------------------------*/
+
+    /***** Loading *****/
+    bool load(const vector<string>& filenames, int threads = 0);
+    /*------------------------------------------------------------------------
+      Replace the history with the orders of the given files.
+
+      Precondition:  None.
+      Postcondition: Every file that could be opened is mapped and parsed
+                     by `threads` threads (one per hardware thread if 0).
+                     Lines that are not orders or a trailer are reported on
+                     cerr with their file and line number and skipped.
+                     Returns false if any file could not be opened.
+    ------------------------------------------------------------------------*/
+
+    static vector<string> findDailyFiles(const string& directory);
+    /*------------------------------------------------------------------------
+      List the completed orders files of a directory.
+
+      Precondition:  None.
+      Postcondition: Returns the paths of the files named like
+                     CompletedOrderStack::dailyFileName(), sorted by the
+                     date in their names (parsed, as months and days are
+                     not zero padded); undated names come last.
+                     Returns an empty list if the directory cannot be read.
+    ------------------------------------------------------------------------*/
+
+    void clear();
+    /*------------------------------------------------------------------------
+      Release every file and order.
+
+      Precondition:  None.
+      Postcondition: The history is empty and its views are invalid.
+    ------------------------------------------------------------------------*/
+
+    /***** Accessors *****/
+    int size() const;
+    const OrderView& getOrder(int index) const;
+    const LineView& getLine(int index) const;
+    /*------------------------------------------------------------------------
+      Retrieve the orders and their item lines.
+
+      Precondition:  0 <= index < size() for getOrder(); for getLine(),
+                     index is within an order's firstLine and lineCount.
+      Postcondition: Returns the view at the given index.
+    ------------------------------------------------------------------------*/
+
+    int fileCount() const;
+    const string& getFileName(int file) const;
+    Money getFileRevenue(int file) const;
+    bool trailerMatches(int file) const;
+    /*------------------------------------------------------------------------
+      Retrieve the files loaded.
+
+      Precondition:  0 <= file < fileCount().
+      Postcondition: getFileRevenue() is the sum of the order totals read
+                     from the file; trailerMatches() tells whether the file
+                     has a revenue trailer equal to it.
+    ------------------------------------------------------------------------*/
+
+    int getErrorCount() const;
+    /*------------------------------------------------------------------------
+      Retrieve the number of lines skipped by the last load().
+
+      Precondition:  None.
+      Postcondition: Returns the number of lines reported on cerr.
+    ------------------------------------------------------------------------*/
+
+    Money calculateTotalRevenue() const;
+    /*------------------------------------------------------------------------
+      Calculate the revenue of every order loaded.
+
+      Precondition:  None.
+      Postcondition: Returns the sum of the files' revenues.
+    ------------------------------------------------------------------------*/
+
+    void printSummary(ostream& out) const;
+    /*------------------------------------------------------------------------
+      Output a summary of the history.
+
+      Precondition:  ostream out is open.
+      Postcondition: Outputs the file, order and line counts, the revenue,
+                     and each file whose trailer does not match its orders.
+    ------------------------------------------------------------------------*/
+
+private:
+    struct File {
+        string name;
+        MappedFile* contents;
+        Money revenue;        // Sum of the order totals
+        Money trailer;        // Revenue recorded in the file
+        bool hasTrailer;
+    };
+
+    struct Chunk;             // One slice of a file, parsed by one thread
+
+    vector<File> files;
+    vector<OrderView> orders;
+    vector<LineView> lines;
+    int errors;
+
+    static void parseChunk(Chunk& chunk);
+    /*------------------------------------------------------------------------
+      Parse the lines of one chunk into its own order and line lists.
+
+      Precondition:  The chunk starts at the beginning of a line and ends
+                     after a newline or at the end of its file.
+      Postcondition: The chunk holds its orders, lines (with firstLine
+                     relative to the chunk), trailer and skipped lines.
+    ------------------------------------------------------------------------*/
+
+    OrderHistory(const OrderHistory& other) = delete;
+    OrderHistory& operator=(const OrderHistory& other) = delete;
+};
+
+#endif // ORDERHISTORY_H
@@ -0,0 +1,489 @@
+/*-- OrderLog.cpp ------------------------------------------------------------
+              This file implements OrderLog member functions.
+--------------------------------------------------------------------------*/
+
+#include "OrderLog.h"
+#include "Trace.h"
+#include "MappedFile.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <map>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#define LOG_OPEN(name) ::open((name), O_WRONLY | O_CREAT | O_APPEND, 0644)
+#define LOG_WRITE ::write
+#define LOG_SYNC ::fsync
+#define LOG_TRUNCATE ::ftruncate
+#define LOG_END(fd) ::lseek((fd), 0, SEEK_END)
+#define LOG_CLOSE ::close
+#else
+#include <io.h>
+#include <fcntl.h>
+#define LOG_OPEN(name) _open((name), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, 0644)
+#define LOG_WRITE _write
+#define LOG_SYNC _commit
+#define LOG_TRUNCATE _chsize
+#define LOG_END(fd) _lseek((fd), 0, SEEK_END)
+#define LOG_CLOSE _close
+#endif
+
+static const size_t RECORD_HEADER = 8; // length + checksum
+static const int WRITE_ATTEMPTS = 3;   // Failed commits a waiter sits through
+
+// FNV-1a over a record's type and payload
+static uint32_t recordChecksum(const char* data, size_t length){
+    uint32_t hash = 2166136261u;
+    for(size_t i = 0; i < length; i++){
+        hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/***** Payload Encoding *****/
+static void putInt32(string& out, int32_t value){
+    out.append((const char*)&value, sizeof(value));
+}
+
+static void putInt64(string& out, int64_t value){
+    out.append((const char*)&value, sizeof(value));
+}
+
+static void putString(string& out, string_view value){
+    putInt32(out, (int32_t)value.size());
+    out += value;
+}
+
+// Reads a payload back, failing instead of running past its end
+struct PayloadReader {
+    const char* position;
+    const char* end;
+
+    bool getInt32(int32_t& value){
+        if(end - position < (ptrdiff_t)sizeof(value))
+            return false;
+        memcpy(&value, position, sizeof(value));
+        position += sizeof(value);
+        return true;
+    }
+
+    bool getInt64(int64_t& value){
+        if(end - position < (ptrdiff_t)sizeof(value))
+            return false;
+        memcpy(&value, position, sizeof(value));
+        position += sizeof(value);
+        return true;
+    }
+
+    bool getString(string& value){
+        int32_t length;
+        if(!getInt32(length) || length < 0 || end - position < length)
+            return false;
+        value.assign(position, length);
+        position += length;
+        return true;
+    }
+};
+
+//--- Definition of OrderLog constructor
+OrderLog::OrderLog()
+    : descriptor(-1), syncInterval(50), syncBatch(256), appended(0),
+      durable(0), flushTarget(0), goodOffset(0), bytesWritten(0), syncs(0),
+      stopping(false), failing(false) {
+}
+
+//--- Definition of OrderLog destructor
+OrderLog::~OrderLog(){
+    close();
+}
+
+//--- Definition of open()
+bool OrderLog::open(const string& filename, int syncInterval, int syncBatch){
+    descriptor = LOG_OPEN(filename.c_str());
+    if(descriptor < 0){
+        cerr << "Error: Could not open file " << filename << endl;
+        return false;
+    }
+
+    this->filename = filename;
+    this->syncInterval = syncInterval > 0 ? syncInterval : 1;
+    this->syncBatch = syncBatch > 0 ? syncBatch : 1;
+    appended = durable = flushTarget = 0;
+    goodOffset = (long long)LOG_END(descriptor);
+    if(goodOffset < 0)
+        goodOffset = 0;
+    bytesWritten = syncs = 0;
+    stopping = failing = false;
+
+    flusher = thread(&OrderLog::flushLoop, this);
+    return true;
+}
+
+//--- Definition of close()
+void OrderLog::close(){
+    if(descriptor < 0)
+        return;
+
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    flusher.join(); // Writes out what is left before exiting
+
+    LOG_CLOSE(descriptor);
+    descriptor = -1;
+}
+
+//--- Definition of isOpen()
+bool OrderLog::isOpen() const {
+    return descriptor >= 0;
+}
+
+//--- Definition of recover()
+int OrderLog::recover(Menu& menu, OrderQueue& orders,
+                      CompletedOrderStack& completed, int& orderId){
+    TRACE_SPAN("OrderLog::recover");
+    MappedFile file;
+    if(descriptor < 0 || !file.open(filename))
+        return 0;
+
+    const char* start = file.data();
+    const char* position = start;
+    const char* end = start + file.size();
+    map<int, Order> pending; // By ID, which is also arrival order
+    int records = 0;
+
+    while(position < end){
+        // Check the frame before trusting anything inside it
+        uint32_t length, checksum;
+        if((size_t)(end - position) < RECORD_HEADER + 1)
+            break;
+        memcpy(&length, position, sizeof(length));
+        memcpy(&checksum, position + 4, sizeof(checksum));
+        if(length == 0 || length > (size_t)(end - position) - RECORD_HEADER
+            || recordChecksum(position + RECORD_HEADER, length) != checksum)
+            break;
+
+        const char* body = position + RECORD_HEADER;
+        PayloadReader payload = { body + 1, body + length };
+        bool ok = true;
+
+        switch(body[0]){
+            case MENU_ADD: {
+                int32_t id;
+                int64_t cents;
+                string name, description;
+                ok = payload.getInt32(id) && payload.getInt64(cents)
+                    && payload.getString(name) && payload.getString(description);
+                if(ok)
+                    menu.addItem(MenuItem(id, name, description, Money(cents)));
+                break;
+            }
+            case MENU_DELETE: {
+                int32_t id;
+                ok = payload.getInt32(id);
+                if(ok)
+                    menu.deleteItem(id); // Already gone after a menu save
+                break;
+            }
+            case MENU_RESET:
+                menu.reset();
+                break;
+            case ORDER_ADD: {
+                int32_t id = 0, lines = 0;
+                string customer;
+                ok = payload.getInt32(id) && payload.getString(customer)
+                    && payload.getInt32(lines);
+
+                Order order(id, customer, &menu);
+                for(int i = 0; ok && i < lines; i++){
+                    int32_t itemId, quantity;
+                    int64_t cents;
+                    ok = payload.getInt32(itemId) && payload.getInt32(quantity)
+                        && payload.getInt64(cents) && quantity > 0;
+                    if(ok)
+                        order.addLine(itemId, quantity, Money(cents));
+                }
+
+                if(ok){
+                    pending[id] = move(order);
+                    if(id >= orderId)
+                        orderId = id + 1;
+                }
+                break;
+            }
+            case ORDER_DELETE: {
+                int32_t id;
+                ok = payload.getInt32(id);
+                if(ok)
+                    pending.erase(id);
+                break;
+            }
+            case ORDER_COMPLETE: {
+                int32_t id;
+                ok = payload.getInt32(id);
+                map<int, Order>::iterator it = ok ? pending.find(id) : pending.end();
+                if(it != pending.end()){
+                    it->second.setStatus('C');
+                    completed.push(move(it->second));
+                    pending.erase(it);
+                }
+                break;
+            }
+            case ORDERS_SAVED: {
+                int32_t count = 0, id;
+                ok = payload.getInt32(count) && count >= 0;
+                for(int i = 0; ok && i < count; i++){
+                    ok = payload.getInt32(id);
+                    if(ok)
+                        completed.markSaved(id);
+                }
+                break;
+            }
+            default:
+                ok = false;
+        }
+
+        if(!ok)
+            break; // Valid checksum but unreadable: written by another version
+        position = body + length;
+        records++;
+    }
+
+    // Orders that never reached the kitchen go back in the queue
+    for(map<int, Order>::iterator it = pending.begin(); it != pending.end(); ++it){
+        orders.enqueue(move(it->second));
+    }
+
+    // Cut off a record torn by the crash so new records follow whole ones
+    if(position < end){
+        cerr << "Warning: Ignoring " << (end - position) << " damaged bytes at the end of "
+             << filename << endl;
+        if(LOG_TRUNCATE(descriptor, (long)(position - start)) != 0)
+            cerr << "Error: Could not truncate " << filename << endl;
+    }
+    {
+        lock_guard<mutex> guard(lock);
+        goodOffset = position - start;
+    }
+
+    return records;
+}
+
+//--- Definition of logMenuAdd()
+void OrderLog::logMenuAdd(const MenuItem& item){
+    string payload;
+    putInt32(payload, item.getId());
+    putInt64(payload, item.getPrice().getCents());
+    putString(payload, item.getName());
+    putString(payload, item.getDescription());
+    append(MENU_ADD, payload);
+}
+
+//--- Definition of logMenuDelete()
+void OrderLog::logMenuDelete(int itemId){
+    string payload;
+    putInt32(payload, itemId);
+    append(MENU_DELETE, payload);
+}
+
+//--- Definition of logMenuReset()
+void OrderLog::logMenuReset(){
+    append(MENU_RESET, string());
+}
+
+//--- Definition of logOrderAdd()
+void OrderLog::logOrderAdd(const Order& order){
+    string payload;
+    putInt32(payload, order.getOrderId());
+    putString(payload, order.getCustomerName());
+    putInt32(payload, order.getItemCount());
+    for(int i = 0; i < order.getItemCount(); i++){
+        const OrderLine& line = order.getLine(i);
+        putInt32(payload, line.itemId);
+        putInt32(payload, line.quantity);
+        putInt64(payload, line.unitPrice.getCents());
+    }
+    append(ORDER_ADD, payload);
+}
+
+//--- Definition of logOrderDelete()
+void OrderLog::logOrderDelete(int orderId){
+    string payload;
+    putInt32(payload, orderId);
+    append(ORDER_DELETE, payload);
+}
+
+//--- Definition of logOrderComplete()
+void OrderLog::logOrderComplete(int orderId){
+    string payload;
+    putInt32(payload, orderId);
+    append(ORDER_COMPLETE, payload);
+}
+
+//--- Definition of logOrdersSaved()
+void OrderLog::logOrdersSaved(const vector<int>& orderIds){
+    string payload;
+    putInt32(payload, (int32_t)orderIds.size());
+    for(size_t i = 0; i < orderIds.size(); i++){
+        putInt32(payload, orderIds[i]);
+    }
+    append(ORDERS_SAVED, payload);
+}
+
+//--- Definition of append()
+void OrderLog::append(RecordType type, const string& payload){
+    if(descriptor < 0)
+        return;
+
+    // Frame the record outside the lock
+    string record(RECORD_HEADER, '\0');
+    record += (char)type;
+    record += payload;
+
+    uint32_t length = (uint32_t)(record.size() - RECORD_HEADER);
+    uint32_t checksum = recordChecksum(record.data() + RECORD_HEADER, length);
+    memcpy(&record[0], &length, sizeof(length));
+    memcpy(&record[4], &checksum, sizeof(checksum));
+
+    bool full;
+    {
+        lock_guard<mutex> guard(lock);
+        buffer += record;
+        appended++;
+        full = appended - durable >= syncBatch;
+    }
+    if(full)
+        wake.notify_one();
+}
+
+//--- Definition of flush()
+void OrderLog::flush(){
+    TRACE_SPAN("OrderLog::flush");
+    if(descriptor < 0)
+        return;
+
+    unique_lock<mutex> guard(lock);
+    long long target = appended;
+    if(target > flushTarget)
+        flushTarget = target;
+    wake.notify_one();
+    synced.wait(guard, [this, target]{ return durable >= target || failing; });
+}
+
+//--- Definition of checkpoint()
+void OrderLog::checkpoint(){
+    TRACE_SPAN("OrderLog::checkpoint");
+    if(descriptor < 0)
+        return;
+
+    // Once every record is durable no write is in flight, and none starts
+    // while the lock is held
+    unique_lock<mutex> guard(lock);
+    flushTarget = appended;
+    wake.notify_one();
+    synced.wait(guard, [this]{ return durable == appended || failing; });
+    if(durable != appended)
+        return;
+
+    if(LOG_TRUNCATE(descriptor, 0) != 0 || LOG_SYNC(descriptor) != 0)
+        cerr << "Error: Could not truncate " << filename << endl;
+    else
+        goodOffset = 0;
+}
+
+//--- Definition of flushLoop()
+void OrderLog::flushLoop(){
+    Trace::setThreadName("log flusher");
+    unique_lock<mutex> guard(lock);
+    int failures = 0;               // Failed commits in a row
+
+    while(true){
+        wake.wait_for(guard, chrono::milliseconds(syncInterval), [this]{
+            return stopping || appended - durable >= syncBatch || flushTarget > durable;
+        });
+
+        if(buffer.empty()){
+            if(stopping)
+                return;
+            continue;
+        }
+
+        // Group commit: take every waiting record and write them at once
+        string pending;
+        pending.swap(buffer);
+        long long target = appended;
+        guard.unlock();
+
+        const char* data = pending.data();
+        size_t left = pending.size();
+        bool failed = false;
+        while(left > 0 && !failed){
+            long written = (long)LOG_WRITE(descriptor, data, (unsigned int)left);
+            if(written < 0 && errno == EINTR)
+                continue;
+            failed = written <= 0;
+            if(!failed){
+                data += written;
+                left -= written;
+            }
+        }
+        failed = failed || LOG_SYNC(descriptor) != 0;
+
+        guard.lock();
+        bytesWritten += pending.size() - left;
+        if(!failed){
+            goodOffset += pending.size();
+            syncs++;
+            failures = 0;
+            failing = false;
+            durable = target;
+            synced.notify_all();
+            continue;
+        }
+
+        // Cut off whatever part of the batch reached the file, so that no
+        // torn record hides the ones after it, and keep the batch ahead of
+        // the records appended since to write it again
+        bool truncated = LOG_TRUNCATE(descriptor, (long)goodOffset) == 0;
+        if(failures == 0){
+            cerr << "Error: Could not write " << filename << ", retrying" << endl;
+            if(!truncated)
+                cerr << "Error: Could not truncate " << filename << endl;
+        }
+        buffer.insert(0, pending);
+        failures++;
+
+        // Release flush() and checkpoint() callers, and close(), rather
+        // than hold them for as long as the disk keeps failing
+        if(failures >= WRITE_ATTEMPTS && !failing){
+            failing = true;
+            synced.notify_all();
+        }
+        if(stopping && failing){
+            cerr << "Error: " << appended - durable << " records were not saved to "
+                 << filename << endl;
+            return;
+        }
+        wake.wait_for(guard, chrono::milliseconds(syncInterval));
+    }
+}
+
+//--- Definition of printStats()
+void OrderLog::printStats(ostream& out) const {
+    lock_guard<mutex> guard(lock);
+
+    out << "Log records: " << appended << ", bytes written: " << bytesWritten
+        << ", fsyncs: " << syncs;
+    if(syncs > 0)
+        out << " (" << fixed << setprecision(1) << (double)durable / syncs
+            << " records per fsync)";
+    out << endl;
+    out.unsetf(ios::fixed);
+    out << setprecision(6);
+}
@@ -0,0 +1,248 @@
+/*-- OrderLog.h --------------------------------------------------------------
+
+  This header file defines the OrderLog class, an append-only write-ahead
+  log of every change to the menu, the pending orders and the completed
+  orders. If the program stops without a clean exit, replaying the log on
+  the next start rebuilds the OrderQueue, the CompletedOrderStack and the
+  menu changes made since the menu file was last saved.
+
+  Records are appended to a memory buffer and written out by a background
+  thread with group commit: one write and one fsync cover every record
+  appended since the last one, either every `syncInterval` milliseconds or
+  as soon as `syncBatch` records are waiting. Appending never waits for
+  the disk, so at most one interval of records can be lost in a crash.
+
+  Record layout (native byte order):
+    length    uint32, bytes of type + payload
+    checksum  uint32, FNV-1a of type + payload
+    type      uint8, one of the RecordType values
+    payload   integers as int32/int64, strings as uint32 length + bytes:
+      MENU_ADD        item ID, price in cents, name, description
+      MENU_DELETE     item ID
+      MENU_RESET      (empty)
+      ORDER_ADD       order ID, customer name, line count, then per line
+                      item ID, quantity and unit price in cents
+      ORDER_DELETE    order ID
+      ORDER_COMPLETE  order ID
+      ORDERS_SAVED    order count, then the ID of each order appended to
+                      the completed orders file
+  A record cut short by a crash fails its length or checksum check; replay
+  stops there and the file is truncated to the last whole record.
+
+  Basic operations:
+    Constructor:       Creates a closed log.
+    Destructor:        Writes out every record and closes the log.
+    open / close:      Open a log file for appending, close it.
+    recover:           Replay the records of the file into the system.
+    log functions:     Append one record per kind of change.
+    flush:             Wait until every appended record is on disk.
+    checkpoint:        Empty the log once its records are saved elsewhere.
+    Statistics:        Records appended, bytes written and fsyncs.
+
+  Class Invariant:
+    1. The file holds only whole, valid records once recover() has run.
+    2. `buffer` holds the records appended since the last successful
+       commit, in order; `appended` and `durable` count records appended
+       and known to be on disk, so durable <= appended. `durable` only
+       moves after an fsync succeeds, and `goodOffset` is the file size
+       after the last one: a failed write or fsync truncates the file back
+       to it and leaves its records in `buffer` to be written again.
+    3. All members below the lock are guarded by `lock`; the flusher thread
+       is the only one that writes to the file while the log is open.
+-----------------------------------------------------------------------------*/
+
+#ifndef ORDERLOG_H
+#define ORDERLOG_H
+
+#include "Menu.h"
+#include "Order.h"
+#include "OrderQueue.h"
+#include "CompletedOrderStack.h"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+class OrderLog {
+public:
+    /***** Record Types *****/
+    enum RecordType {
+        MENU_ADD = 1,
+        MENU_DELETE = 2,
+        MENU_RESET = 3,
+        ORDER_ADD = 4,
+        ORDER_DELETE = 5,
+        ORDER_COMPLETE = 6,
+        ORDERS_SAVED = 7
+    };
+
+    /***** Constructor and Destructor *****/
+    OrderLog();
+    /*------------------------------------------------------------------------
+      Construct a closed log.
+
+      Precondition:  None.
+      Postcondition: isOpen() is false; records appended are discarded.
+    ------------------------------------------------------------------------*/
+
+    ~OrderLog();
+    /*------------------------------------------------------------------------
+      Destructor: Closes the log.
+
+      Precondition:  None.
+      Postcondition: Every appended record is on disk and the flusher
+                     thread has been joined.
+    ------------------------------------------------------------------------*/
+
+    /***** File Operations *****/
+    bool open(const string& filename, int syncInterval = 50, int syncBatch = 256);
+    /*------------------------------------------------------------------------
+      Open a log file for appending, creating it if needed.
+
+      Precondition:  The log is closed.
+      Postcondition: Returns true and starts the flusher thread, which
+                     syncs every syncInterval milliseconds or after
+                     syncBatch records. Returns false and reports the error
+                     on cerr if the file cannot be opened.
+    ------------------------------------------------------------------------*/
+
+    int recover(Menu& menu, OrderQueue& orders, CompletedOrderStack& completed,
+                int& orderId);
+    /*------------------------------------------------------------------------
+      Replay the records already in the log file.
+
+      Precondition:  The log is open and nothing has been appended yet.
+                     menu holds the menu file as last saved.
+      Postcondition: Menu records are applied to menu (adds replace items
+                     with the same ID, deleting a missing item is ignored,
+                     so replaying twice is harmless). Orders still pending
+                     at the end are enqueued in their original order, and
+                     completed ones are pushed onto completed in completion
+                     order, with those a save had already written passed
+                     to completed.markSaved(). orderId is raised past
+                     every order ID seen.
+                     A torn or damaged tail is reported and cut off.
+                     Returns the number of records replayed.
+    ------------------------------------------------------------------------*/
+
+    void close();
+    /*------------------------------------------------------------------------
+      Close the log.
+
+      Precondition:  None.
+      Postcondition: Same as the destructor; the log can be opened again.
+    ------------------------------------------------------------------------*/
+
+    bool isOpen() const;
+    /*------------------------------------------------------------------------
+      Check whether records are being logged.
+
+      Precondition:  None.
+      Postcondition: Returns true between a successful open() and close().
+    ------------------------------------------------------------------------*/
+
+    /***** Logging Operations *****/
+    void logMenuAdd(const MenuItem& item);
+    void logMenuDelete(int itemId);
+    void logMenuReset();
+    void logOrderAdd(const Order& order);
+    void logOrderDelete(int orderId);
+    void logOrderComplete(int orderId);
+    /*------------------------------------------------------------------------
+      Append the record of one change.
+
+      Precondition:  Called for each change that succeeded, before it is
+                     reported to the user. Any thread may append.
+      Postcondition: The record is buffered and will be on disk within one
+                     sync interval. Does nothing if the log is closed.
+    ------------------------------------------------------------------------*/
+
+    void logOrdersSaved(const vector<int>& orderIds);
+    /*------------------------------------------------------------------------
+      Append the record of a save of completed orders.
+
+      Precondition:  orderIds are the IDs appendToFile() wrote.
+      Postcondition: As for the other log functions; after a restart the
+                     recovered orders among them are not saved again.
+    ------------------------------------------------------------------------*/
+
+    void flush();
+    /*------------------------------------------------------------------------
+      Wait for the records appended so far to be written and synced.
+
+      Precondition:  None.
+      Postcondition: Every record appended before the call is on disk, or
+                     the file has failed WRITE_ATTEMPTS commits in a row
+                     and the records stay buffered for later retries.
+    ------------------------------------------------------------------------*/
+
+    void checkpoint();
+    /*------------------------------------------------------------------------
+      Empty the log.
+
+      Precondition:  Everything the log protects has been saved elsewhere
+                     (the menu file) or is meant to be discarded (orders at
+                     a clean exit).
+      Postcondition: The log file is empty; logging continues after it.
+                     If commits to the file keep failing, it is left as is.
+    ------------------------------------------------------------------------*/
+
+    /***** Statistics *****/
+    void printStats(ostream& out) const;
+    /*------------------------------------------------------------------------
+      Output the log's counters.
+
+      Precondition:  ostream out is open.
+      Postcondition: Outputs the records appended, bytes written, fsyncs
+                     and records per fsync since the log was opened.
+    ------------------------------------------------------------------------*/
+
+private:
+    string filename;                // Path of the open log
+    int descriptor;                 // File descriptor, -1 when closed
+    int syncInterval;               // Milliseconds between group commits
+    int syncBatch;                  // Waiting records that force a commit
+    thread flusher;                 // Runs flushLoop() while open
+
+    mutable mutex lock;             // Guards everything below
+    condition_variable wake;        // Wakes the flusher early
+    condition_variable synced;      // Signalled after each group commit
+    string buffer;                  // Records not yet written
+    long long appended;             // Records appended since open()
+    long long durable;              // Records written and synced
+    long long flushTarget;          // Records flush() callers wait for
+    long long goodOffset;           // File size after the last good commit
+    long long bytesWritten;
+    long long syncs;
+    bool stopping;                  // Set by close()
+    bool failing;                   // WRITE_ATTEMPTS commits in a row failed
+
+    void append(RecordType type, const string& payload);
+    /*------------------------------------------------------------------------
+      Frame a record and add it to the buffer.
+
+      Precondition:  None.
+      Postcondition: The record is buffered if the log is open, and the
+                     flusher is woken when syncBatch records are waiting.
+    ------------------------------------------------------------------------*/
+
+    void flushLoop();
+    /*------------------------------------------------------------------------
+      Body of the flusher thread.
+
+      Precondition:  The log is open.
+      Postcondition: Writes and syncs the buffer at every interval, batch
+                     or flush() request, until close(). A failed commit is
+                     reported once and retried every interval. After
+                     WRITE_ATTEMPTS failures in a row waiters are released;
+                     once close() is waiting as well the flusher gives up
+                     and reports the records lost on cerr.
+    ------------------------------------------------------------------------*/
+
+    OrderLog(const OrderLog& other) = delete;
+    OrderLog& operator=(const OrderLog& other) = delete;
+};
+
+#endif // ORDERLOG_H
@@ -3,6 +3,8 @@
 --------------------------------------------------------------------------*/
 
 #include "OrderQueue.h"
+#include "Metrics.h"
+#include "Trace.h"
 
 //--- Definition of OrderQueue constructor
 OrderQueue::OrderQueue(){
@@ -19,6 +21,7 @@ OrderQueue::~OrderQueue(){
     while (current != NULL) {
         nextNode = current->next;
         delete current;
+        METRIC_ADD(QUEUE_DEPTH, -1);
         current = nextNode;
     }
 
@@ -31,27 +34,43 @@ bool OrderQueue::isEmpty() const {
     return front == NULL;
 }
 
-//--- Definition of enqueue()
-void OrderQueue::enqueue(const Order& order){
-    NodePtr newNode = new(nothrow) Node(order);
-    
+//--- Definition of link()
+bool OrderQueue::link(NodePtr newNode){
     if(!newNode){
+        METRIC_INC(ALLOCATION_FAILURES);
         cerr << "Memory Allocation Failed" << endl;
-        return;
+        return false;
     }
+    newNode->data.stamp(Order::ENQUEUED);
+    METRIC_INC(ORDERS_ENQUEUED);
+    METRIC_ADD(QUEUE_DEPTH, 1);
 
     if(isEmpty()){
         front = newNode;
         rear = front;
-        return;
+        return true;
     }
     
     rear->next = newNode;
     rear = newNode;
+    return true;
+}
+
+//--- Definition of enqueue()
+void OrderQueue::enqueue(const Order& order){
+    TRACE_SPAN("OrderQueue::enqueue");
+    link(new(nothrow) Node(order));
+}
+
+//--- Definition of enqueue() taking an rvalue
+void OrderQueue::enqueue(Order&& order){
+    TRACE_SPAN("OrderQueue::enqueue");
+    link(new(nothrow) Node(move(order)));
 }
 
 //--- Definition of dequeue()
 Order OrderQueue::dequeue() {
+    TRACE_SPAN("OrderQueue::dequeue");
     if (isEmpty()) {
         cerr << "Queue is empty!" << endl;
         return Order();
@@ -63,8 +82,11 @@ Order OrderQueue::dequeue() {
     if(front == NULL)
         rear = NULL;
     
-    Order order = temp->data;
+    Order order = move(temp->data); // Hand the lines over, no copy
     order.setStatus('C');
+    order.stamp(Order::DEQUEUED);
+    METRIC_INC(ORDERS_DEQUEUED);
+    METRIC_ADD(QUEUE_DEPTH, -1);
     
     delete temp;
     return order;
@@ -72,6 +94,7 @@ Order OrderQueue::dequeue() {
 
 //--- Definition of deleteOrder()
 bool OrderQueue::deleteOrder(int orderId){
+    TRACE_SPAN("OrderQueue::deleteOrder");
     if(isEmpty()){
         return false;
     }
@@ -83,6 +106,8 @@ bool OrderQueue::deleteOrder(int orderId){
             rear = NULL;
         }
         delete temp;  // Free the memory of the deleted node
+        METRIC_INC(ORDERS_CANCELLED);
+        METRIC_ADD(QUEUE_DEPTH, -1);
         return true;
     }
     
@@ -97,6 +122,8 @@ bool OrderQueue::deleteOrder(int orderId){
             }
 
             delete temp; // Free the memory of the deleted node
+            METRIC_INC(ORDERS_CANCELLED);
+            METRIC_ADD(QUEUE_DEPTH, -1);
             return true;
         }
         
@@ -107,6 +134,7 @@ bool OrderQueue::deleteOrder(int orderId){
 
 //--- Definition of display()
 void OrderQueue::display() const {
+    TRACE_SPAN("OrderQueue::display");
     cout << "--- Active Orders ---" << endl;
     
     if(isEmpty()){
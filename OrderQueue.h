@@ -6,8 +6,11 @@
   Basic operations:
     Constructor:       Initializes an empty queue.
     Destructor:        Releases dynamically allocated memory for the queue.
+                       Nodes come from the shared NodePool, so a warm queue
+                       enqueues and dequeues without heap allocations.
     isEmpty:           Checks if the queue is empty.
-    enqueue:           Adds an Order to the rear of the queue.
+    enqueue:           Adds an Order to the rear of the queue, by copy or by move.
+    emplace:           Constructs an Order directly in a node at the rear.
     dequeue:           Removes and returns the Order at the front of the queue.
     deleteOrder:       Deletes an Order by its order ID from the queue.
     display:           Outputs the contents of the queue.
@@ -25,7 +28,9 @@
 #define ORDERQUEUE_H
 
 #include "Order.h"
+#include "NodePool.h"
 #include <iostream>
+#include <utility>
 
 using namespace std;
 
@@ -66,13 +71,35 @@ public:
       Postcondition: The specified Order is added to the rear of the queue.
     --------------------------------------------------------------------*/
 
+    void enqueue(Order&& order);
+    /*--------------------------------------------------------------------
+      Move an Order to the rear of the queue.
+
+      Precondition:  None.
+      Postcondition: The specified Order is moved into a node at the rear of
+                     the queue without copying its lines; order is left 
+                     empty.
+    --------------------------------------------------------------------*/
+
+    template <typename... Args>
+    Order* emplace(Args&&... args);
+    /*--------------------------------------------------------------------
+      Construct an Order in place at the rear of the queue.
+
+      Precondition:  args are valid arguments for an Order constructor.
+      Postcondition: A new Order built from args is added to the rear of
+                     the queue. Returns a pointer to it so items can be 
+                     added, or NULL if memory allocation failed.
+    --------------------------------------------------------------------*/
+
     Order dequeue();
     /*--------------------------------------------------------------------
       Remove and return the Order at the front of the queue.
 
       Precondition:  The queue is not empty.
       Postcondition: The Order at the front of the queue is removed and 
-                     returned. Throws an exception if the queue is empty.
+                     moved out to the caller with its status set to 'C'.
+                     Returns a default Order if the queue is empty.
     --------------------------------------------------------------------*/
 
     bool deleteOrder(int orderId);
@@ -101,13 +128,49 @@ private:
         Node* next;  // Pointer to the next Node in the queue
 
         Node(const Order& data) : data(data), next(NULL) {};
+        Node(Order&& data) : data(move(data)), next(NULL) {};
         /*--------------------------------------------------------------------
-          Construct a Node with the given Order.
+          Construct a Node with the given Order, copied or moved.
 
           Precondition:  None.
           Postcondition: A Node is created with the specified Order and the 
                          next pointer initialized to NULL.
         --------------------------------------------------------------------*/
+
+        template <typename... Args>
+        Node(in_place_t, Args&&... args) 
+            : data(forward<Args>(args)...), next(NULL) {};
+        /*--------------------------------------------------------------------
+          Construct a Node whose Order is built in place from args.
+
+          Precondition:  args are valid arguments for an Order constructor.
+          Postcondition: A Node is created holding Order(args...) and the
+                         next pointer initialized to NULL.
+        --------------------------------------------------------------------*/
+
+        static void* operator new(size_t bytes){
+            void* block = NodePool::shared().allocate(bytes);
+            if(!block)
+                throw bad_alloc();
+            return block;
+        }
+        static void* operator new(size_t bytes, const nothrow_t&) noexcept {
+            return NodePool::shared().allocate(bytes);
+        }
+        static void operator delete(void* block, size_t bytes){
+            NodePool::shared().deallocate(block, bytes);
+        }
+        static void operator delete(void* block, const nothrow_t&) noexcept {
+            NodePool::shared().deallocate(block, sizeof(Node));
+        }
+        /*--------------------------------------------------------------------
+          Nodes are allocated from the shared NodePool instead of the heap.
+
+          Precondition:  None.
+          Postcondition: new returns a recycled or slab block (or NULL for 
+                         the nothrow form when memory is exhausted); delete
+                         returns the block to the pool.
+        --------------------------------------------------------------------*/
     };
 
     typedef Node* NodePtr;
@@ -115,8 +178,27 @@ private:
     NodePtr front;  // Pointer to the first Node in the queue
     NodePtr rear;   // Pointer to the last Node in the queue
 
+    bool link(NodePtr newNode);
+    /*--------------------------------------------------------------------
+      Attach a newly allocated node at the rear of the queue.
+
+      Precondition:  newNode is NULL or a node not yet in any queue.
+      Postcondition: newNode becomes the rear of the queue. Returns false,
+                     after reporting the failure, if newNode is NULL.
+    --------------------------------------------------------------------*/
+
 };
 
+/***** Template Definitions *****/
+template <typename... Args>
+Order* OrderQueue::emplace(Args&&... args){
+    NodePtr newNode = new(nothrow) Node(in_place, forward<Args>(args)...);
+    if(!link(newNode))
+        return NULL;
+
+    return &newNode->data;
+}
+
 /***** Overloaded Operators *****/
 ostream& operator<<(ostream& out, const OrderQueue& orderQueue);
 /*--------------------------------------------------------------------
@@ -0,0 +1,184 @@
+/*-- StringTable.cpp ---------------------------------------------------------
+              This file implements StringTable member functions.
+--------------------------------------------------------------------------*/
+
+#include "StringTable.h"
+#include "Metrics.h"
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <new>
+
+static const size_t CHUNK_BYTES = 64 * 1024;    // Text storage allocated at once
+static const size_t LARGE_TEXT = CHUNK_BYTES / 8; // Longer texts get their own
+
+// A handle with the hash of its text, so probes past other texts do not
+// have to read their entries
+struct StringTableBucket {
+    StringTable::Handle handle;          // EMPTY marks an unused bucket
+    unsigned int hash;
+};
+
+// The hash table of every handle, and where the next text is copied
+struct StringTableState {
+    mutex tableLock;
+    StringTableBucket* buckets = NULL;
+    unsigned int bucketCount = 0;        // Always a power of two
+    unsigned int count = 1;              // Next handle; EMPTY is taken
+    long long bytes = 0;
+    char* chunk = NULL;                  // Unused end of the current chunk
+    size_t chunkLeft = 0;
+
+    StringTable::Entry& entry(StringTable::Handle handle){
+        return StringTable::directory[handle >> StringTable::BLOCK_BITS]
+                                     [handle & (StringTable::BLOCK_ENTRIES - 1)];
+    }
+
+    bool grow();
+    const char* store(string_view text);
+};
+
+// Never destroyed: views of the text outlive every static object
+static StringTableState& state(){
+    static StringTableState* instance = new StringTableState();
+    return *instance;
+}
+
+// FNV-1a
+static unsigned int hashText(string_view text){
+    unsigned int hash = 2166136261u;
+    for(size_t i = 0; i < text.size(); i++){
+        hash = (hash ^ (unsigned char)text[i]) * 16777619u;
+    }
+    return hash;
+}
+
+//--- Definition of StringTableState::grow()
+bool StringTableState::grow(){
+    unsigned int newCount = bucketCount > 0 ? bucketCount * 2 : 1024;
+    StringTableBucket* newBuckets = new(nothrow) StringTableBucket[newCount]();
+    if(!newBuckets){
+        METRIC_INC(ALLOCATION_FAILURES);
+        cerr << "Memory Allocation Failed" << endl;
+        return false;
+    }
+
+    unsigned int mask = newCount - 1;
+    for(unsigned int old = 0; old < bucketCount; old++){
+        if(buckets[old].handle == StringTable::EMPTY)
+            continue;
+        unsigned int bucket = buckets[old].hash & mask;
+        while(newBuckets[bucket].handle != StringTable::EMPTY)
+            bucket = (bucket + 1) & mask;
+        newBuckets[bucket] = buckets[old];
+    }
+
+    delete [] buckets;
+    buckets = newBuckets;
+    bucketCount = newCount;
+    return true;
+}
+
+//--- Definition of StringTableState::store()
+const char* StringTableState::store(string_view text){
+    if(text.size() > LARGE_TEXT){
+        char* own = new(nothrow) char[text.size()];
+        if(!own){
+            METRIC_INC(ALLOCATION_FAILURES);
+            cerr << "Memory Allocation Failed" << endl;
+            return NULL;
+        }
+        memcpy(own, text.data(), text.size());
+        return own;
+    }
+
+    if(text.size() > chunkLeft){
+        // The rest of the old chunk is given up, at most LARGE_TEXT bytes
+        char* fresh = new(nothrow) char[CHUNK_BYTES];
+        if(!fresh){
+            METRIC_INC(ALLOCATION_FAILURES);
+            cerr << "Memory Allocation Failed" << endl;
+            return NULL;
+        }
+        chunk = fresh;
+        chunkLeft = CHUNK_BYTES;
+    }
+
+    char* copy = chunk;
+    memcpy(copy, text.data(), text.size());
+    chunk += text.size();
+    chunkLeft -= text.size();
+    return copy;
+}
+
+//--- Definition of intern()
+StringTable::Handle StringTable::intern(string_view text){
+    if(text.empty())
+        return EMPTY;
+
+    unsigned int hash = hashText(text);
+    StringTableState& table = state();
+    lock_guard<mutex> guard(table.tableLock);
+
+    // Keep the table at most half full so probes stay short
+    if(2 * table.count >= table.bucketCount && !table.grow())
+        return EMPTY;
+
+    unsigned int mask = table.bucketCount - 1;
+    unsigned int bucket = hash & mask;
+    while(table.buckets[bucket].handle != EMPTY){
+        if(table.buckets[bucket].hash == hash){
+            const Entry& found = table.entry(table.buckets[bucket].handle);
+            if(found.length == text.size()
+                && memcmp(found.text, text.data(), text.size()) == 0)
+                return table.buckets[bucket].handle;
+        }
+        bucket = (bucket + 1) & mask;
+    }
+
+    // A new text: fill its entry before the handle can be seen
+    Handle handle = table.count;
+    int block = (int)(handle >> BLOCK_BITS);
+    if(block >= MAX_BLOCKS){
+        cerr << "Error: String table full" << endl;
+        return EMPTY;
+    }
+    if(directory[block] == NULL){
+        directory[block] = new(nothrow) Entry[BLOCK_ENTRIES];
+        if(directory[block] == NULL){
+            METRIC_INC(ALLOCATION_FAILURES);
+            cerr << "Memory Allocation Failed" << endl;
+            return EMPTY;
+        }
+    }
+
+    const char* copy = table.store(text);
+    if(copy == NULL)
+        return EMPTY;
+
+    Entry& created = table.entry(handle);
+    created.text = copy;
+    created.length = (unsigned int)text.size();
+    table.buckets[bucket].handle = handle;
+    table.buckets[bucket].hash = hash;
+    table.count++;
+    table.bytes += text.size();
+
+    METRIC_INC(INTERNED_STRINGS);
+    METRIC_ADD(INTERNED_BYTES, (long long)text.size());
+    return handle;
+}
+
+//--- Definition of getCount()
+long long StringTable::getCount(){
+    StringTableState& table = state();
+    lock_guard<mutex> guard(table.tableLock);
+    return table.count - 1;
+}
+
+//--- Definition of getBytes()
+long long StringTable::getBytes(){
+    StringTableState& table = state();
+    lock_guard<mutex> guard(table.tableLock);
+    return table.bytes;
+}
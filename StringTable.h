@@ -0,0 +1,98 @@
+/*-- StringTable.h -----------------------------------------------------------
+
+  This header file defines the StringTable class, the process-wide table
+  of interned menu text. Every distinct name and description is stored
+  once, and a MenuItem holds the 32-bit handles of its text instead of
+  two std::strings of its own: "Soft Drink" on a hundred items is kept
+  once, copying an item copies a few integers, and two texts are equal
+  exactly when their handles are.
+
+  Strings are never removed. The views get() returns stay valid for as
+  long as the program runs, even after the item that interned them is
+  deleted, and the table grows with the distinct text ever seen rather
+  than with the number of items.
+
+  Interning takes a lock; reading a handle does not. Entries live in
+  fixed-size blocks that never move, so get() is two array reads, safe
+  on any thread that received the handle through a queue, a lock or the
+  start of the thread.
+
+  Basic operations:
+    intern:            Returns the handle of a text, storing it if it is new.
+    get:               Returns the text of a handle.
+    getCount:          Returns the number of distinct texts stored.
+    getBytes:          Returns the number of bytes of text stored.
+
+  Class Invariant:
+    1. Handle 0 (EMPTY) is the empty string. Every other handle h is entry
+       h % BLOCK_ENTRIES of block h / BLOCK_ENTRIES of `directory`, and no
+       two entries hold the same text.
+    2. The hash table of StringTable.cpp holds the handle of every entry
+       but EMPTY, is at most half full, and is guarded by its lock.
+-----------------------------------------------------------------------------*/
+
+#ifndef STRINGTABLE_H
+#define STRINGTABLE_H
+
+#include <string_view>
+
+using namespace std;
+
+class StringTable {
+public:
+    typedef unsigned int Handle;
+    static const Handle EMPTY = 0;
+
+    /***** Interning *****/
+    static Handle intern(string_view text);
+    /*------------------------------------------------------------------------
+      Find or store a text.
+
+      Precondition:  None.
+      Postcondition: Returns the handle of text, the same for every call
+                     with equal text; EMPTY for the empty string. If the
+                     table cannot grow the error is reported on cerr and
+                     EMPTY is returned.
+    ------------------------------------------------------------------------*/
+
+    /***** Reading *****/
+    static string_view get(Handle handle){
+        const Entry& entry = directory[handle >> BLOCK_BITS][handle & (BLOCK_ENTRIES - 1)];
+        return string_view(entry.text, entry.length);
+    }
+    /*------------------------------------------------------------------------
+      Retrieve the text of a handle.
+
+      Precondition:  handle was returned by intern().
+      Postcondition: Returns a view of the text, valid until the program
+                     exits.
+    ------------------------------------------------------------------------*/
+
+    static long long getCount();
+    static long long getBytes();
+    /*------------------------------------------------------------------------
+      Measure the table.
+
+      Precondition:  None.
+      Postcondition: Returns the number of distinct texts stored, or the
+                     bytes of text they hold.
+    ------------------------------------------------------------------------*/
+
+private:
+    struct Entry {
+        const char* text;
+        unsigned int length;
+    };
+
+    static const int BLOCK_BITS = 12;
+    static const unsigned int BLOCK_ENTRIES = 1u << BLOCK_BITS;
+    static const int MAX_BLOCKS = 1 << 16;  // Room for 2^28 texts
+
+    // Block 0 is static so that EMPTY resolves before anything is interned
+    inline static Entry firstBlock[BLOCK_ENTRIES] = {};
+    inline static Entry* directory[MAX_BLOCKS] = { firstBlock };
+
+    friend struct StringTableState;
+};
+
+#endif // STRINGTABLE_H
@@ -0,0 +1,228 @@
+/*-- Trace.cpp ---------------------------------------------------------------
+              This file implements Trace member functions.
+--------------------------------------------------------------------------*/
+
+#include "Trace.h"
+#include "Metrics.h"
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Every buffer ever created, in the order threads started tracing
+struct TraceRegistry {
+    mutex registryLock;
+    vector<Trace::Buffer*> buffers;
+};
+
+// Never destroyed, so threads can still trace during shutdown
+static TraceRegistry& registry(){
+    static TraceRegistry* instance = new TraceRegistry();
+    return *instance;
+}
+
+// Name given by setThreadName() before the thread had a buffer
+static thread_local const char* pendingThreadName = NULL;
+static thread_local bool allocationFailed = false;
+
+// Writes a string as a JSON string literal
+static void writeJsonString(ostream& out, const char* text){
+    out << '"';
+    for(const char* c = text; *c; c++){
+        if(*c == '"' || *c == '\\')
+            out << '\\' << *c;
+        else if((unsigned char)*c < 0x20)
+            out << ' ';
+        else
+            out << *c;
+    }
+    out << '"';
+}
+
+// Writes trace clock nanoseconds as the microseconds of the JSON format
+static void writeMicroseconds(ostream& out, long long nanoseconds){
+    out << nanoseconds / 1000 << '.';
+    long long fraction = nanoseconds % 1000;
+    out << (char)('0' + fraction / 100) << (char)('0' + fraction / 10 % 10)
+        << (char)('0' + fraction % 10);
+}
+
+//--- Definition of enable()
+void Trace::enable(){
+    enabled.store(true, memory_order_relaxed);
+}
+
+//--- Definition of disable()
+void Trace::disable(){
+    enabled.store(false, memory_order_relaxed);
+}
+
+//--- Definition of attach()
+Trace::Buffer* Trace::attach(){
+    if(allocationFailed)
+        return NULL; // Tried once, the thread goes untraced
+
+    Buffer* buffer = new(nothrow) Buffer;
+    if(!buffer){
+        METRIC_INC(ALLOCATION_FAILURES);
+        cerr << "Memory Allocation Failed" << endl;
+        allocationFailed = true;
+        return NULL;
+    }
+    buffer->head.store(0, memory_order_relaxed);
+    buffer->threadName.store(pendingThreadName, memory_order_relaxed);
+
+    TraceRegistry& shared = registry();
+    {
+        lock_guard<mutex> guard(shared.registryLock);
+        buffer->threadId = (int)shared.buffers.size() + 1;
+        shared.buffers.push_back(buffer);
+    }
+    local = buffer;
+    return buffer;
+}
+
+//--- Definition of append()
+void Trace::append(Kind kind, const char* name, int orderId, long long start, long long end){
+    Buffer* buffer = local;
+    if(!buffer && !(buffer = attach()))
+        return;
+
+    // Fill the slot, then publish it by moving head past it
+    unsigned long long index = buffer->head.load(memory_order_relaxed);
+    Event& event = buffer->events[index & (BUFFER_EVENTS - 1)];
+    event.name.store(name, memory_order_relaxed);
+    event.start.store(start, memory_order_relaxed);
+    event.duration.store(end - start, memory_order_relaxed);
+    event.kind.store(kind, memory_order_relaxed);
+    event.orderId.store(orderId, memory_order_relaxed);
+    buffer->head.store(index + 1, memory_order_release);
+}
+
+//--- Definition of complete()
+void Trace::complete(const char* name, long long start, long long end){
+    if(isEnabled())
+        append(SPAN, name, 0, start, end);
+}
+
+//--- Definition of orderInterval()
+void Trace::orderInterval(const char* name, int orderId, long long start, long long end){
+    if(isEnabled())
+        append(ORDER, name, orderId, start, end);
+}
+
+//--- Definition of setThreadName()
+void Trace::setThreadName(const char* name){
+    pendingThreadName = name;
+    if(local)
+        local->threadName.store(name, memory_order_relaxed);
+}
+
+//--- Definition of writeJson()
+long long Trace::writeJson(ostream& out){
+    TraceRegistry& shared = registry();
+    lock_guard<mutex> guard(shared.registryLock);
+
+    long long written = 0;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    const char* separator = "\n";
+    for(size_t b = 0; b < shared.buffers.size(); b++){
+        const Buffer* buffer = shared.buffers[b];
+        int tid = buffer->threadId;
+
+        const char* threadName = buffer->threadName.load(memory_order_relaxed);
+        if(threadName){
+            out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+                << ",\"args\":{\"name\":";
+            writeJsonString(out, threadName);
+            out << "}}";
+            separator = ",\n";
+        }
+
+        unsigned long long head = buffer->head.load(memory_order_acquire);
+        unsigned long long first = head > (unsigned long long)BUFFER_EVENTS ? head - BUFFER_EVENTS : 0;
+        for(unsigned long long i = first; i < head; i++){
+            const Event& event = buffer->events[i & (BUFFER_EVENTS - 1)];
+            const char* name = event.name.load(memory_order_relaxed);
+            long long start = event.start.load(memory_order_relaxed);
+            long long duration = event.duration.load(memory_order_relaxed);
+            int kind = event.kind.load(memory_order_relaxed);
+            int orderId = event.orderId.load(memory_order_relaxed);
+
+            // The writer may have lapped the reader: the slot it is filling
+            // now and every slot it has filled since are newer than read
+            atomic_thread_fence(memory_order_acquire);
+            unsigned long long latest = buffer->head.load(memory_order_relaxed);
+            if(latest + 1 > i + BUFFER_EVENTS)
+                continue;
+
+            out << separator;
+            separator = ",\n";
+            if(kind == SPAN){
+                out << "{\"name\":";
+                writeJsonString(out, name);
+                out << ",\"cat\":\"rms\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid << ",\"ts\":";
+                writeMicroseconds(out, start);
+                out << ",\"dur\":";
+                writeMicroseconds(out, duration);
+                out << "}";
+            } else {
+                // An async begin/end pair; pairs with the same id share a track
+                for(int end = 0; end < 2; end++){
+                    if(end)
+                        out << ",\n";
+                    out << "{\"name\":";
+                    writeJsonString(out, name);
+                    out << ",\"cat\":\"order\",\"ph\":\"" << (end ? 'e' : 'b')
+                        << "\",\"id\":" << orderId << ",\"pid\":1,\"tid\":" << tid << ",\"ts\":";
+                    writeMicroseconds(out, end ? start + duration : start);
+                    out << "}";
+                }
+            }
+            written++;
+        }
+    }
+    out << "\n]}\n";
+    return written;
+}
+
+//--- Definition of exportToFile()
+long long Trace::exportToFile(const string& filename){
+    ofstream outFile(filename);
+    if(!outFile){
+        cerr << "Error: Unable to open file " << filename << endl;
+        return -1;
+    }
+
+    long long written = writeJson(outFile);
+    outFile.close();
+    if(!outFile){
+        cerr << "Error: Unable to write file " << filename << endl;
+        return -1;
+    }
+    return written;
+}
+
+//--- Definition of getOverwritten()
+long long Trace::getOverwritten(){
+    TraceRegistry& shared = registry();
+    lock_guard<mutex> guard(shared.registryLock);
+
+    long long overwritten = 0;
+    for(size_t b = 0; b < shared.buffers.size(); b++){
+        unsigned long long head = shared.buffers[b]->head.load(memory_order_relaxed);
+        if(head > (unsigned long long)BUFFER_EVENTS)
+            overwritten += head - BUFFER_EVENTS;
+    }
+    return overwritten;
+}
+
+//--- Definition of clear()
+void Trace::clear(){
+    TraceRegistry& shared = registry();
+    lock_guard<mutex> guard(shared.registryLock);
+
+    for(size_t b = 0; b < shared.buffers.size(); b++){
+        shared.buffers[b]->head.store(0, memory_order_relaxed);
+    }
+}
@@ -0,0 +1,219 @@
+/*-- Trace.h -----------------------------------------------------------------
+
+  This header file defines the Trace class and the TraceSpan guard, which
+  record a timeline of what the system spends its time on: loading and
+  saving files, queue operations, orders in the kitchen and the reports
+  of main. The timeline is written in the Chrome trace-event JSON format,
+  which chrome://tracing and ui.perfetto.dev open directly.
+
+  A span is declared at the top of a scope with TRACE_SPAN("name") and
+  covers the rest of the scope. While tracing is off, a span costs a load
+  and a branch; building with RMS_NO_TRACE defined compiles spans out.
+  While tracing is on, each thread writes its events into a ring buffer of
+  its own, without locks, keeping the newest BUFFER_EVENTS events; older
+  ones are overwritten. Orders also get a timeline of their own, from
+  creation to completion with their wait in the queue, recorded by the
+  kitchen from the order's lifecycle timestamps.
+
+  Event names must be string literals (or otherwise live until the trace
+  is written), as only the pointer is stored.
+
+  Basic operations:
+    enable / disable:  Start and stop recording.
+    TraceSpan:         Records the duration of a scope.
+    complete:          Records an interval measured by the caller.
+    orderInterval:     Records an interval on the timeline of an order.
+    setThreadName:     Names the calling thread in the timeline.
+    writeJson:         Outputs every buffered event as trace JSON.
+    exportToFile:      Writes the trace JSON to a file.
+    clear:             Drops every buffered event.
+
+  Class Invariant:
+    1. A buffer is written only by its thread; `head` counts the events
+       ever written to it, the newest min(head, BUFFER_EVENTS) of which
+       are in `events` at index % BUFFER_EVENTS.
+    2. Buffers are registered in `buffers`, guarded by `registryLock`, and
+       are kept until the program ends so that the events of threads that
+       have exited can still be written.
+-----------------------------------------------------------------------------*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+#define TRACE_JOIN_NAMES(a, b) a##b
+#define TRACE_UNIQUE_NAME(a, b) TRACE_JOIN_NAMES(a, b)
+#ifndef RMS_NO_TRACE
+#define TRACE_SPAN(name) TraceSpan TRACE_UNIQUE_NAME(traceSpan, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#endif
+
+class Trace {
+public:
+    static const int BUFFER_EVENTS = 1 << 15;  // Per thread, a power of two
+
+    /***** Recording *****/
+    static void enable();
+    static void disable();
+    static bool isEnabled(){
+        return enabled.load(memory_order_relaxed);
+    }
+    /*------------------------------------------------------------------------
+      Start, stop or check recording.
+
+      Precondition:  None.
+      Postcondition: While enabled, spans and intervals are recorded.
+                     Events already recorded are kept.
+    ------------------------------------------------------------------------*/
+
+    static long long now(){
+        return chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    /*------------------------------------------------------------------------
+      Read the trace clock.
+
+      Precondition:  None.
+      Postcondition: Returns steady clock nanoseconds, the clock of
+                     Order::monotonicNanos().
+    ------------------------------------------------------------------------*/
+
+    static void complete(const char* name, long long start, long long end);
+    /*------------------------------------------------------------------------
+      Record an interval of the calling thread.
+
+      Precondition:  name lives until the trace is written; start <= end,
+                     both from now().
+      Postcondition: The interval is in the thread's buffer, unless tracing
+                     is off.
+    ------------------------------------------------------------------------*/
+
+    static void orderInterval(const char* name, int orderId, long long start, long long end);
+    /*------------------------------------------------------------------------
+      Record an interval on the timeline of an order.
+
+      Precondition:  As for complete().
+      Postcondition: The interval is shown on its own track, shared by
+                     every interval of the same order, instead of on the
+                     thread that recorded it.
+    ------------------------------------------------------------------------*/
+
+    static void setThreadName(const char* name);
+    /*------------------------------------------------------------------------
+      Name the calling thread.
+
+      Precondition:  name lives until the trace is written.
+      Postcondition: The thread's events are shown under name.
+    ------------------------------------------------------------------------*/
+
+    /***** Output *****/
+    static long long writeJson(ostream& out);
+    /*------------------------------------------------------------------------
+      Output every buffered event in the Chrome trace-event JSON format.
+
+      Precondition:  ostream out is open. Threads may keep recording.
+      Postcondition: Outputs one JSON object with a traceEvents array, and
+                     returns the number of events in it. Events overwritten
+                     while being read are left out.
+    ------------------------------------------------------------------------*/
+
+    static long long exportToFile(const string& filename);
+    /*------------------------------------------------------------------------
+      Write the trace JSON to a file.
+
+      Precondition:  None.
+      Postcondition: Returns the number of events written, or -1 after
+                     reporting an error if the file cannot be written.
+    ------------------------------------------------------------------------*/
+
+    static long long getOverwritten();
+    /*------------------------------------------------------------------------
+      Retrieve how many events were lost to full buffers.
+
+      Precondition:  None.
+      Postcondition: Returns the number of events that have been
+                     overwritten by newer ones since the last clear().
+    ------------------------------------------------------------------------*/
+
+    static void clear();
+    /*------------------------------------------------------------------------
+      Drop every buffered event.
+
+      Precondition:  No thread is recording.
+      Postcondition: The buffers are empty; thread names are kept.
+    ------------------------------------------------------------------------*/
+
+private:
+    enum Kind { SPAN, ORDER };
+
+    // Fields are written by one thread and may be read by the exporter
+    // at the same time, hence relaxed atomics
+    struct Event {
+        atomic<const char*> name;
+        atomic<long long> start;
+        atomic<long long> duration;
+        atomic<int> kind;
+        atomic<int> orderId;
+    };
+
+    struct Buffer {
+        Event events[BUFFER_EVENTS];
+        atomic<unsigned long long> head;
+        atomic<const char*> threadName;
+        int threadId;
+    };
+
+    inline static atomic<bool> enabled{false};
+    inline static thread_local Buffer* local = NULL;  // This thread's buffer
+
+    static void append(Kind kind, const char* name, int orderId, long long start, long long end);
+    static Buffer* attach();
+    /*------------------------------------------------------------------------
+      Add an event to the calling thread's buffer, creating it first.
+
+      Precondition:  None.
+      Postcondition: The event is the newest of the buffer; attach()
+                     returns NULL if the buffer cannot be allocated.
+    ------------------------------------------------------------------------*/
+
+    friend struct TraceRegistry;
+};
+
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name)
+        : name(name), start(Trace::isEnabled() ? Trace::now() : 0) {}
+    /*------------------------------------------------------------------------
+      Start a span; use TRACE_SPAN so it can be compiled out.
+
+      Precondition:  name lives until the trace is written.
+      Postcondition: If tracing is on, the time is taken.
+    ------------------------------------------------------------------------*/
+
+    ~TraceSpan(){
+        if(start != 0)
+            Trace::complete(name, start, Trace::now());
+    }
+    /*------------------------------------------------------------------------
+      End the span.
+
+      Precondition:  None.
+      Postcondition: The span is recorded if it was started with tracing on.
+    ------------------------------------------------------------------------*/
+
+private:
+    const char* name;
+    long long start;  // 0 when tracing was off
+
+    TraceSpan(const TraceSpan& other) = delete;
+    TraceSpan& operator=(const TraceSpan& other) = delete;
+};
+
+#endif // TRACE_H
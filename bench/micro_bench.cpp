@@ -0,0 +1,453 @@
+/*---------------------------------------------------------------------
+  Data Structure Microbenchmarks
+
+  This program times the hot operations of Menu, Order, OrderQueue and
+  CompletedOrderStack at sizes from 10 up to a maximum (1M by default,
+  10M with `--max 10000000`, which needs a few GB of memory):
+    - Menu:                 add, lookup hit, lookup miss, price lookups
+                            one at a time and in bulk, search by name
+                            and description, delete + re-add, save and
+                            load, as text and as a snapshot.
+    - Order:                addItem and calculateTotalAmount.
+    - OrderQueue:           enqueue, dequeue and deleteOrder.
+    - CompletedOrderStack:  push, pop, getOrder, revenue (running total and
+                            a full walk of the orders), and full and
+                            incremental saves.
+    - OrderAnalytics:       loading the column store from a stack, revenue,
+                            revenue of a period, sales by item and order
+                            size histogram.
+  For every operation it reports the time, the heap allocations and the
+  bytes allocated per operation. Allocations are counted by replacing the
+  global operator new, so blocks served from the NodePool free list do
+  not count, but new pool slabs do.
+
+  Build (from this directory):
+    g++ -std=c++17 -O2 -I.. micro_bench.cpp ../Menu.cpp ../MenuItem.cpp
+        ../MenuSearch.cpp ../StringTable.cpp ../Order.cpp ../OrderQueue.cpp
+        ../CompletedOrderStack.cpp ../Money.cpp ../NodePool.cpp ../MappedFile.cpp
+        ../OrderAnalytics.cpp ../Metrics.cpp ../Trace.cpp -pthread -o micro_bench
+
+  Usage:
+    micro_bench [--max N] [--filter text] [--csv file] [--json file]
+      --max N        Largest size to run (default 1000000).
+      --filter text  Only report benchmarks whose name contains text.
+      --csv file     Also write the results as CSV.
+      --json file    Also write the results as a JSON array.
+
+  Output: One line per benchmark and size: name, size, operations timed,
+          ns/op, allocs/op and bytes/op.
+  ---------------------------------------------------------------------*/
+
+#include "Menu.h"
+#include "Order.h"
+#include "OrderQueue.h"
+#include "CompletedOrderStack.h"
+#include "OrderAnalytics.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/***** Allocation Counting *****/
+static atomic<long long> allocationCount(0);
+static atomic<long long> allocationBytes(0);
+
+void* operator new(size_t bytes){
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    allocationBytes.fetch_add(bytes, memory_order_relaxed);
+
+    void* block = malloc(bytes == 0 ? 1 : bytes);
+    if(!block)
+        throw bad_alloc();
+    return block;
+}
+
+void* operator new[](size_t bytes){
+    return operator new(bytes);
+}
+
+void* operator new(size_t bytes, const nothrow_t&) noexcept {
+    try {
+        return operator new(bytes);
+    } catch(const bad_alloc&) {
+        return NULL;
+    }
+}
+
+void* operator new[](size_t bytes, const nothrow_t&) noexcept {
+    return operator new(bytes, nothrow);
+}
+
+void operator delete(void* block) noexcept { free(block); }
+void operator delete[](void* block) noexcept { free(block); }
+void operator delete(void* block, size_t) noexcept { free(block); }
+void operator delete[](void* block, size_t) noexcept { free(block); }
+
+/***** Results *****/
+struct Result {
+    string name;
+    long long size;         // Items or orders in the structure
+    long long operations;   // Operations timed
+    double nsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;
+};
+
+static vector<Result> results;
+static string filter;
+
+// Keeps the optimizer from discarding a computed value
+static volatile long long sink;
+
+/**
+ * measure(name, size, operations, body)
+ * Purpose:
+ *   Runs body once, timing it and counting its allocations, and records
+ *   the cost per operation.
+ * Input: body performs `operations` operations on a structure of `size`.
+ */
+template <typename Body>
+void measure(const string& name, long long size, long long operations, Body body){
+    // Filtered-out steps still run: later benchmarks build on their state
+    if(!filter.empty() && name.find(filter) == string::npos){
+        body();
+        return;
+    }
+
+    long long allocations = allocationCount.load();
+    long long bytes = allocationBytes.load();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    body();
+
+    double nanoseconds = chrono::duration<double, nano>(
+        chrono::steady_clock::now() - start).count();
+    allocations = allocationCount.load() - allocations;
+    bytes = allocationBytes.load() - bytes;
+
+    Result result;
+    result.name = name;
+    result.size = size;
+    result.operations = operations;
+    result.nsPerOp = nanoseconds / operations;
+    result.allocsPerOp = (double)allocations / operations;
+    result.bytesPerOp = (double)bytes / operations;
+    results.push_back(result);
+
+    cout << left << setw(22) << name << right << setw(10) << size
+         << setw(10) << operations << fixed << setprecision(1)
+         << setw(12) << result.nsPerOp << setprecision(2)
+         << setw(10) << result.allocsPerOp << setprecision(1)
+         << setw(12) << result.bytesPerOp << endl;
+    cout.unsetf(ios::fixed);
+}
+
+// Deterministic pseudo-random numbers (64-bit LCG), the same every run
+static unsigned long long seed = 88172645463325252ULL;
+static long long nextRandom(long long bound){
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (long long)((seed >> 33) % (unsigned long long)bound);
+}
+
+static MenuItem makeItem(int id){
+    return MenuItem(id, "Item " + to_string(id), "Freshly made dish",
+                    Money(199 + id % 1000));
+}
+
+// Number of probes for an O(size) operation, so each run stays short
+static long long linearProbes(long long size){
+    long long probes = 100000000 / size;
+    return probes < 10 ? 10 : (probes > 1000 ? 1000 : probes);
+}
+
+/***** Benchmarks *****/
+static void benchMenu(long long n){
+    Menu menu;
+    measure("menu_add", n, n, [&]{
+        for(int id = 1; id <= n; id++)
+            menu.addItem(makeItem(id));
+    });
+
+    long long lookups = n < 1000000 ? 1000000 : n;
+    vector<int> ids(lookups);
+    for(long long i = 0; i < lookups; i++)
+        ids[i] = (int)nextRandom(n) + 1;
+
+    measure("menu_lookup_hit", n, lookups, [&]{
+        long long found = 0;
+        for(long long i = 0; i < lookups; i++)
+            found += menu.getItemById(ids[i]).getId();
+        sink = found;
+    });
+
+    measure("menu_lookup_miss", n, lookups, [&]{
+        long long found = 0;
+        for(long long i = 0; i < lookups; i++)
+            found += menu.getItemById(ids[i] + (int)n).getId();
+        sink = found;
+    });
+
+    measure("menu_price_lookup", n, lookups, [&]{
+        Money total;
+        for(long long i = 0; i < lookups; i++){
+            Money price;
+            if(menu.getPrice(ids[i], price))
+                total += price;
+        }
+        sink = total.getCents();
+    });
+
+    vector<Money> prices;
+    measure("menu_price_bulk", n, lookups, [&]{
+        menu.getPrices(ids, prices);
+        Money total;
+        for(long long i = 0; i < lookups; i++)
+            total += prices[i];
+        sink = total.getCents();
+    });
+
+    // A word shared by every item, a rare word, and a description prefix
+    const char* queries[] = { "item", "ITEM 4", "it " , "fresh dish", "mad" };
+    long long searches = 100000;
+    measure("menu_search", n, searches, [&]{
+        long long found = 0;
+        for(long long i = 0; i < searches; i++)
+            found += (long long)menu.search(queries[i % 5], 10).size();
+        sink = found;
+    });
+
+    long long churn = n < 100000 ? n : 100000;
+    measure("menu_delete_add", n, churn, [&]{
+        for(long long i = 0; i < churn; i++){
+            int id = ids[i];
+            if(menu.deleteItem(id))
+                menu.addItem(makeItem(id));
+        }
+    });
+
+    const char* file = "micro_bench_menu.txt";
+    measure("menu_save", n, n, [&]{ menu.saveToFile(file); });
+
+    Menu loaded;
+    measure("menu_load", n, n, [&]{ loaded.loadFromFile(file); });
+    remove(file);
+
+    const char* snapshot = "micro_bench_menu.bin";
+    measure("menu_snapshot_save", n, n, [&]{ menu.saveSnapshot(snapshot); });
+
+    Menu mapped;
+    measure("menu_snapshot_load", n, n, [&]{ mapped.loadSnapshot(snapshot); });
+    measure("menu_snapshot_lookup", n, lookups, [&]{
+        long long found = 0;
+        for(long long i = 0; i < lookups; i++)
+            found += mapped.getItemById(ids[i]).getId();
+        sink = found;
+    });
+    remove(snapshot);
+}
+
+static void benchOrder(long long n){
+    // addItem scans the lines of the order, so large orders are skipped
+    if(n > 10000)
+        return;
+
+    Menu menu;
+    for(int id = 1; id <= n; id++)
+        menu.addItem(makeItem(id));
+
+    Order order(1, "Customer", &menu);
+    measure("order_add_item", n, n, [&]{
+        for(int id = 1; id <= n; id++)
+            order.addItem(menu.getItemById(id));
+    });
+
+    long long totals = 10000000 / n;
+    measure("order_total", n, totals * n, [&]{
+        long long cents = 0;
+        for(long long i = 0; i < totals; i++)
+            cents += order.calculateTotalAmount().getCents();
+        sink = cents;
+    });
+}
+
+static void benchQueue(long long n){
+    MenuItem item = makeItem(1);
+    OrderQueue queue;
+
+    measure("queue_enqueue", n, n, [&]{
+        for(int id = 1; id <= n; id++){
+            Order order(id, "Customer");
+            order.addItem(item);
+            queue.enqueue(move(order));
+        }
+    });
+
+    long long probes = linearProbes(n);
+    measure("queue_delete_order", n, probes, [&]{
+        long long deleted = 0;
+        for(long long i = 0; i < probes; i++)
+            deleted += queue.deleteOrder((int)nextRandom(n) + 1);
+        sink = deleted;
+    });
+
+    long long remaining = 0;
+    measure("queue_dequeue", n, n, [&]{
+        while(!queue.isEmpty()){
+            remaining += queue.dequeue().getOrderId();
+        }
+        sink = remaining;
+    });
+}
+
+static void benchStack(long long n){
+    MenuItem item = makeItem(1);
+    CompletedOrderStack stack;
+
+    measure("stack_push", n, n, [&]{
+        for(int id = 1; id <= n; id++){
+            Order order(id, "Customer");
+            order.addItem(item);
+            stack.push(move(order));
+        }
+    });
+
+    long long probes = linearProbes(n);
+    measure("stack_get_order", n, probes, [&]{
+        long long found = 0;
+        for(long long i = 0; i < probes; i++)
+            found += stack.getOrder((int)nextRandom(n)).getOrderId();
+        sink = found;
+    });
+
+    measure("stack_revenue_total", n, 1, [&]{
+        sink = stack.calculateTotalRevenue().getCents();
+    });
+
+    measure("stack_revenue_walk", n, n, [&]{
+        Money total;
+        CompletedOrderStack::const_iterator it;
+        for(it = stack.begin(); it != stack.end(); ++it)
+            total += it->calculateTotalAmount();
+        sink = total.getCents();
+    });
+
+    const char* file = "micro_bench_orders.txt";
+    measure("stack_save", n, n, [&]{ stack.saveToFile(file); });
+    remove(file);
+
+    // Incremental saves: everything once, then only the order completed since
+    measure("stack_append_all", n, n, [&]{ sink = stack.appendToFile(file); });
+    Order extra((int)n + 1, "Customer");
+    extra.addItem(item);
+    stack.push(move(extra));
+    measure("stack_append_one", n, 1, [&]{ sink = stack.appendToFile(file); });
+    remove(file);
+
+    measure("stack_pop", n, n, [&]{
+        long long popped = 0;
+        while(!stack.isEmpty())
+            popped += stack.pop().getOrderId();
+        sink = popped;
+    });
+}
+
+static void benchAnalytics(long long n){
+    // Orders of one to three lines over 100 items
+    CompletedOrderStack stack;
+    for(int id = 1; id <= n; id++){
+        Order order(id, "Customer");
+        for(int line = 0; line <= id % 3; line++)
+            order.addItem(makeItem((int)nextRandom(100) + 1));
+        stack.push(move(order));
+    }
+
+    OrderAnalytics analytics;
+    measure("analytics_load", n, n, [&]{ analytics.loadFrom(stack); });
+
+    long long lines = analytics.lineCount();
+    measure("analytics_revenue", n, lines, [&]{
+        sink = analytics.calculateTotalRevenue().getCents();
+    });
+
+    measure("analytics_period", n, lines, [&]{
+        sink = analytics.revenueBetween(0, 1).getCents();
+    });
+
+    measure("analytics_by_item", n, lines, [&]{
+        sink = (long long)analytics.salesByItem().size();
+    });
+
+    measure("analytics_histogram", n, n, [&]{
+        sink = analytics.orderSizeHistogram(10)[1];
+    });
+}
+
+/***** Output Files *****/
+static void writeCsv(const string& filename){
+    ofstream out(filename);
+    out << "name,size,operations,ns_per_op,allocs_per_op,bytes_per_op\n";
+    for(size_t i = 0; i < results.size(); i++){
+        const Result& r = results[i];
+        out << r.name << ',' << r.size << ',' << r.operations << ','
+            << r.nsPerOp << ',' << r.allocsPerOp << ',' << r.bytesPerOp << '\n';
+    }
+}
+
+static void writeJson(const string& filename){
+    ofstream out(filename);
+    out << "[\n";
+    for(size_t i = 0; i < results.size(); i++){
+        const Result& r = results[i];
+        out << "  {\"name\": \"" << r.name << "\", \"size\": " << r.size
+            << ", \"operations\": " << r.operations
+            << ", \"ns_per_op\": " << r.nsPerOp
+            << ", \"allocs_per_op\": " << r.allocsPerOp
+            << ", \"bytes_per_op\": " << r.bytesPerOp << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+}
+
+int main(int argc, char* argv[]){
+    long long maxSize = 1000000;
+    string csvFile, jsonFile;
+
+    for(int i = 1; i + 1 < argc; i += 2){
+        if(strcmp(argv[i], "--max") == 0)
+            maxSize = atoll(argv[i + 1]);
+        else if(strcmp(argv[i], "--filter") == 0)
+            filter = argv[i + 1];
+        else if(strcmp(argv[i], "--csv") == 0)
+            csvFile = argv[i + 1];
+        else if(strcmp(argv[i], "--json") == 0)
+            jsonFile = argv[i + 1];
+    }
+
+    cout << left << setw(22) << "benchmark" << right << setw(10) << "size"
+         << setw(10) << "ops" << setw(12) << "ns/op" << setw(10) << "allocs/op"
+         << setw(12) << "bytes/op" << endl;
+
+    for(long long n = 10; n <= maxSize; n *= 10){
+        benchMenu(n);
+        benchOrder(n);
+        benchQueue(n);
+        benchStack(n);
+        benchAnalytics(n);
+    }
+
+    if(!csvFile.empty())
+        writeCsv(csvFile);
+    if(!jsonFile.empty())
+        writeJson(jsonFile);
+
+    return 0;
+}
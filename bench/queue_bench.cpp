@@ -0,0 +1,149 @@
+/*---------------------------------------------------------------------
+  Order Queue Throughput Benchmark
+
+  This program measures how many orders per second pass through the
+  lock-free ConcurrentOrderQueue and through an OrderQueue protected by a
+  mutex, with 1 to 16 producer threads and as many consumer threads. Every
+  run is also a stress check: each order ID must be dequeued exactly once
+  and every order must keep its lines.
+
+  Build (from this directory):
+    g++ -std=c++17 -O2 -pthread -I.. queue_bench.cpp ../ConcurrentOrderQueue.cpp
+        ../OrderQueue.cpp ../Order.cpp ../Menu.cpp ../MenuItem.cpp ../MenuSearch.cpp
+        ../StringTable.cpp ../Money.cpp ../NodePool.cpp ../MappedFile.cpp
+        ../Metrics.cpp ../Trace.cpp -o queue_bench
+
+  Usage:
+    queue_bench [orders per run]     (default 1000000)
+
+  Output: One line per queue and thread count with the throughput, and a
+          final FAILED line if any run lost or duplicated an order.
+  ---------------------------------------------------------------------*/
+
+#include "ConcurrentOrderQueue.h"
+#include "OrderQueue.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * MutexOrderQueue
+ * Purpose:
+ *   Baseline: the single-threaded OrderQueue behind one mutex.
+ */
+class MutexOrderQueue {
+public:
+    void enqueue(Order&& order){
+        lock_guard<mutex> guard(lock);
+        queue.enqueue(move(order));
+    }
+
+    bool tryDequeue(Order& order){
+        lock_guard<mutex> guard(lock);
+        if(queue.isEmpty())
+            return false;
+        order = queue.dequeue();
+        return true;
+    }
+
+private:
+    mutex lock;
+    OrderQueue queue;
+};
+
+/**
+ * runBenchmark(int threads, int orders)
+ * Purpose:
+ *   Pushes `orders` orders through a fresh queue of type Queue with
+ *   `threads` producers and `threads` consumers.
+ * Output: Orders per second, or -1 if an order was lost or duplicated.
+ */
+template <typename Queue>
+double runBenchmark(int threads, int orders){
+    Queue queue;
+    vector<atomic<unsigned char>> seen(orders + 1);
+    for(size_t i = 0; i < seen.size(); i++)
+        seen[i].store(0);
+
+    atomic<int> consumed(0);
+    atomic<bool> corrupt(false);
+    MenuItem item(1, "Burger", "Juicy beef burger", Money(549));
+
+    auto start = chrono::steady_clock::now();
+
+    vector<thread> workers;
+    for(int p = 0; p < threads; p++){
+        workers.push_back(thread([&, p](){
+            // Producer p enqueues IDs p+1, p+1+threads, ...
+            for(int id = p + 1; id <= orders; id += threads){
+                Order order(id, "Customer");
+                order.addItem(item);
+                queue.enqueue(move(order));
+            }
+        }));
+    }
+    for(int c = 0; c < threads; c++){
+        workers.push_back(thread([&](){
+            Order order;
+            while(consumed.load(memory_order_relaxed) < orders){
+                if(!queue.tryDequeue(order))
+                    continue;
+
+                int id = order.getOrderId();
+                if(id < 1 || id > orders || seen[id].fetch_add(1) != 0
+                    || order.getItemCount() != 1)
+                    corrupt.store(true);
+                consumed.fetch_add(1, memory_order_relaxed);
+            }
+        }));
+    }
+    for(size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    double seconds = chrono::duration<double>(
+        chrono::steady_clock::now() - start).count();
+
+    for(int id = 1; id <= orders; id++){
+        if(seen[id].load() != 1)
+            corrupt.store(true);
+    }
+
+    return corrupt.load() ? -1 : orders / seconds;
+}
+
+int main(int argc, char* argv[]){
+    int orders = argc > 1 ? atoi(argv[1]) : 1000000;
+    if(orders < 1)
+        orders = 1000000;
+
+    const int threadCounts[] = {1, 2, 4, 8, 16};
+    bool failed = false;
+
+    cout << "orders per run: " << orders << endl;
+    cout << left << setw(10) << "threads" << setw(22) << "lock-free (ops/s)"
+         << setw(22) << "mutex (ops/s)" << "speedup" << endl;
+
+    for(int threads : threadCounts){
+        double lockFree = runBenchmark<ConcurrentOrderQueue>(threads, orders);
+        double locked = runBenchmark<MutexOrderQueue>(threads, orders);
+        failed = failed || lockFree < 0 || locked < 0;
+
+        cout << left << setw(10) << threads << fixed << setprecision(0)
+             << setw(22) << lockFree << setw(22) << locked
+             << setprecision(2) << lockFree / locked << endl;
+    }
+
+    if(failed){
+        cout << "FAILED: an order was lost, duplicated or damaged" << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,259 @@
+/*---------------------------------------------------------------------
+  Restaurant Workload Generator
+
+  This program writes a synthetic menu and a matching order stream for
+  load testing. The same seed and options always produce the same files.
+
+  The menu has the layout of `menu.txt` (id,name,description,price) with
+  IDs 1..N. Names are repeated categories ("Soft Drink", "Juice", ...) as
+  in the sample menu, descriptions are 10 to 40 characters long, and
+  prices fall in a range typical of the category.
+
+  The order stream is a BatchDriver script (see ../BatchDriver.h):
+    - Orders arrive as a Poisson process at --rate orders per minute.
+    - Items are picked with Zipfian popularity: the item of rank r is
+      chosen with probability proportional to 1 / r^s. Ranks are shuffled
+      over the menu, so popular items are not just the first IDs.
+    - Order sizes follow a geometric distribution with mean --size.
+    - With probability --cancel, a pending order is cancelled shortly
+      after an order arrives.
+    - The kitchen runs a `process` cycle every --cycle seconds of
+      simulated time, and the script ends with `process` and `revenue`.
+
+  Build (from this directory):
+    g++ -std=c++17 -O2 -I.. workload_gen.cpp ../Money.cpp -o workload_gen
+
+  Usage:
+    workload_gen [--seed S] [--items N] [--orders M] [--rate R] [--zipf s]
+                 [--size k] [--cancel p] [--cycle T]
+                 [--menu file] [--script file]
+      Defaults: seed 1, 1000 items, 10000 orders, 60 orders per minute,
+                s = 1.0, k = 3, p = 0.02, T = 60 seconds,
+                workload_menu.txt and workload_script.txt.
+
+    The output runs with:
+      main --menu workload_menu.txt --batch workload_script.txt
+
+  Output: The two files, and a summary line on the console.
+  ---------------------------------------------------------------------*/
+
+#include "Money.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/***** Vocabulary *****/
+struct Category {
+    const char* name;
+    long long minCents;   // Price range of the category
+    long long maxCents;
+};
+
+static const Category categories[] = {
+    {"Pizza", 799, 1699},      {"Burger", 549, 1299},
+    {"Pasta", 699, 1499},      {"Salad", 449, 999},
+    {"Sandwich", 499, 899},    {"Soup", 349, 699},
+    {"Dessert", 299, 799},     {"Soft Drink", 150, 350},
+    {"Juice", 250, 450},       {"Hot Drink", 199, 399},
+    {"Coffee", 199, 499},      {"Smoothie", 399, 649}
+};
+static const int categoryCount = sizeof(categories) / sizeof(categories[0]);
+
+static const char* adjectives[] = {
+    "Fresh", "Spicy", "Classic", "Homemade", "Crispy", "Smoky", "Creamy",
+    "Grilled", "Tangy", "Sweet", "Rich aromatic", "Juicy", "Chilled", "Hot"
+};
+static const char* ingredients[] = {
+    "cheese", "beef", "chicken", "tomato", "mushroom", "garden", "orange",
+    "pineapple", "lemon", "mint", "chocolate", "vanilla", "basil", "truffle"
+};
+static const char* dishes[] = {
+    "special", "with sauce", "house blend", "of the day", "deluxe",
+    "with fries", "on the side", "with herbs and olive oil", "classic"
+};
+static const char* firstNames[] = {
+    "Jane", "John", "Bahaa", "Maria", "Omar", "Li", "Sara", "Tom", "Nour",
+    "Ana", "Karim", "Emma", "Yusuf", "Lea", "Ravi", "Mia"
+};
+static const char* lastNames[] = {
+    "Doe", "Smith", "Haddad", "Garcia", "Chen", "Khalil", "Martin", "Rossi",
+    "Nasser", "Kim", "Silva", "Dubois"
+};
+
+#define COUNT(array) (int)(sizeof(array) / sizeof(array[0]))
+
+/***** Deterministic Random Numbers *****/
+// mt19937_64 produces the same sequence everywhere; the distributions are
+// computed here because the standard ones differ between libraries.
+static mt19937_64 generator;
+
+static double uniform(){
+    return (generator() >> 11) * (1.0 / 9007199254740992.0); // [0, 1)
+}
+
+static int pick(int bound){
+    return (int)(uniform() * bound);
+}
+
+static double exponential(double mean){
+    return -log(1.0 - uniform()) * mean;
+}
+
+static int geometric(double mean){
+    if(mean <= 1)
+        return 1;
+    double p = 1.0 / mean;
+    return 1 + (int)floor(log(1.0 - uniform()) / log(1.0 - p));
+}
+
+/**
+ * writeMenu(filename, items)
+ * Purpose:
+ *   Writes a menu of `items` items in the `menu.txt` layout.
+ * Output: false if the file cannot be written.
+ */
+static bool writeMenu(const string& filename, int items){
+    ofstream file(filename);
+    if(!file)
+        return false;
+
+    for(int id = 1; id <= items; id++){
+        const Category& category = categories[pick(categoryCount)];
+        string description = string(adjectives[pick(COUNT(adjectives))]) + " "
+            + ingredients[pick(COUNT(ingredients))] + " "
+            + dishes[pick(COUNT(dishes))];
+
+        // Prices end in 0, 5 or 9 cents, like a real menu
+        long long cents = category.minCents
+            + pick((int)(category.maxCents - category.minCents + 1));
+        const long long endings[] = {0, 5, 9};
+        cents = cents / 10 * 10 + endings[pick(3)];
+
+        file << id << ',' << category.name << ',' << description << ','
+             << Money(cents) << '\n';
+    }
+    return true;
+}
+
+/**
+ * buildZipf(items, s)
+ * Purpose:
+ *   Builds the cumulative distribution of Zipfian item popularity over
+ *   shuffled ranks.
+ * Output: cdf[i] is the probability of picking an item ID <= i + 1.
+ */
+static vector<double> buildZipf(int items, double s){
+    vector<int> rank(items);
+    for(int i = 0; i < items; i++)
+        rank[i] = i + 1;
+    for(int i = items - 1; i > 0; i--) // Fisher-Yates with our own numbers
+        swap(rank[i], rank[pick(i + 1)]);
+
+    vector<double> cdf(items);
+    double total = 0;
+    for(int i = 0; i < items; i++){
+        total += 1.0 / pow(rank[i], s);
+        cdf[i] = total;
+    }
+    for(int i = 0; i < items; i++)
+        cdf[i] /= total;
+    return cdf;
+}
+
+int main(int argc, char* argv[]){
+    unsigned long long seed = 1;
+    int items = 1000, orders = 10000;
+    double rate = 60, zipf = 1.0, meanSize = 3, cancelRate = 0.02, cycle = 60;
+    string menuFile = "workload_menu.txt", scriptFile = "workload_script.txt";
+
+    for(int i = 1; i + 1 < argc; i += 2){
+        const char* option = argv[i];
+        const char* value = argv[i + 1];
+        if(strcmp(option, "--seed") == 0) seed = strtoull(value, NULL, 10);
+        else if(strcmp(option, "--items") == 0) items = atoi(value);
+        else if(strcmp(option, "--orders") == 0) orders = atoi(value);
+        else if(strcmp(option, "--rate") == 0) rate = atof(value);
+        else if(strcmp(option, "--zipf") == 0) zipf = atof(value);
+        else if(strcmp(option, "--size") == 0) meanSize = atof(value);
+        else if(strcmp(option, "--cancel") == 0) cancelRate = atof(value);
+        else if(strcmp(option, "--cycle") == 0) cycle = atof(value);
+        else if(strcmp(option, "--menu") == 0) menuFile = value;
+        else if(strcmp(option, "--script") == 0) scriptFile = value;
+        else {
+            cerr << "Unknown option " << option << endl;
+            return 1;
+        }
+    }
+
+    if(items < 1 || orders < 0 || rate <= 0 || cycle <= 0){
+        cerr << "--items, --rate and --cycle must be positive" << endl;
+        return 1;
+    }
+
+    generator.seed(seed);
+    if(!writeMenu(menuFile, items)){
+        cerr << "Error: Could not open file " << menuFile << endl;
+        return 1;
+    }
+
+    ofstream script(scriptFile);
+    if(!script){
+        cerr << "Error: Could not open file " << scriptFile << endl;
+        return 1;
+    }
+
+    vector<double> cdf = buildZipf(items, zipf);
+    vector<int> pending;       // Order IDs waiting for the next cycle
+    double now = 0;            // Simulated seconds
+    double nextCycle = cycle;
+    int cancelled = 0, cycles = 0;
+
+    script << "# workload_gen --seed " << seed << " --items " << items
+           << " --orders " << orders << " --rate " << rate << " --zipf " << zipf
+           << " --size " << meanSize << " --cancel " << cancelRate
+           << " --cycle " << cycle << "\n";
+
+    // BatchDriver numbers orders from 1 as they are created
+    for(int orderId = 1; orderId <= orders; orderId++){
+        now += exponential(60.0 / rate);
+        while(now >= nextCycle){
+            script << "process\n";
+            pending.clear();
+            nextCycle += cycle;
+            cycles++;
+        }
+
+        script << "order " << firstNames[pick(COUNT(firstNames))] << ' '
+               << lastNames[pick(COUNT(lastNames))] << ':';
+        int size = geometric(meanSize);
+        for(int i = 0; i < size; i++){
+            int id = (int)(lower_bound(cdf.begin(), cdf.end(), uniform())
+                           - cdf.begin());
+            script << ' ' << (id < items ? id + 1 : items);
+        }
+        script << '\n';
+        pending.push_back(orderId);
+
+        if(uniform() < cancelRate){
+            int victim = pick((int)pending.size());
+            script << "cancel " << pending[victim] << '\n';
+            pending.erase(pending.begin() + victim);
+            cancelled++;
+        }
+    }
+    script << "process\nrevenue\n";
+
+    cout << "Wrote " << items << " menu items to " << menuFile << " and "
+         << orders << " orders (" << cancelled << " cancelled, " << cycles + 1
+         << " kitchen cycles over " << (int)now << " s) to " << scriptFile
+         << endl;
+    return 0;
+}
@@ -7,19 +7,40 @@
 
   Input:  User choices for various menu operations and inputs such as item
           details, customer names, and order IDs.
+          With `--batch <file>` (or `--batch -` for standard input) the
+          commands are read from a script instead, without prompts; see
+          BatchDriver.h for the script format. `--menu <file>` loads and
+          saves that menu file instead of `menu.txt`; it may be a text menu
+          or a binary snapshot (see tools/menu_convert.cpp), and is saved
+          back in the same format. `--log <file>` sets the write-ahead log
+          (default `orders.log`; batch mode logs only when it is given).
+          Orders and menu changes in the log are replayed at start, so a
+          crash loses at most the last few milliseconds of the shift.
+          `--metrics <file>` writes the counters and gauges of the system
+          to that file every few seconds, in Prometheus text format.
+          `--trace <file>` records a timeline of the session from the start
+          and writes it to that file on exit, in Chrome trace-event JSON
+          (open it in chrome://tracing or ui.perfetto.dev).
   Output: Displays the menu, order status, revenue reports, and various
-          success/error messages.
+          success/error messages. In batch mode, a timing report; the exit
+          status is 1 if any command failed.
 
   Methods:
     - `addMenuItem`: Adds a new menu item based on user input.
     - `deleteMenuItem`: Deletes a menu item by its ID.
     - `resetMenu`: Resets the menu to an empty state.
     - `addNewOrder`: Allows the user to create a new order by selecting menu items.
-    - `processNextOrder`: Processes the next order in the queue.
+    - `processOrders`: Sends every pending order through the kitchen workers.
     - `displayOrder`: Displays pending and completed orders.
     - `deleteOrder`: Deletes an order from the queue by its ID.
     - `calculateTotalRevenue`: Calculates and displays the total revenue from all completed orders.
-    - `saveCompletedOrdersToFile`: Saves all completed orders to a file.
+    - `bestSellers`: Displays the items sold most this hour, today and overall.
+    - `saveCompletedOrdersToFile`: Appends the orders completed since the last save to a file.
+    - `salesReport`: Displays the quantity and revenue sold per item and the order sizes.
+    - `latencyReport`: Displays how long orders waited in the queue and took to complete.
+    - `metricsReport`: Displays the counters and gauges of the system.
+    - `exportTrace`: Starts tracing, or writes the timeline traced so far to a file.
+    - `searchMenu`: Finds menu items by the words of their names and descriptions.
     - `exit`: Saves the current menu to a file and exits the program.
 
   Note:
@@ -33,37 +54,145 @@
 #include "CompletedOrderStack.h"
 #include "OrderQueue.h"
 #include "Order.h"
+#include "KitchenExecutor.h"
+#include "BatchDriver.h"
+#include "OrderLog.h"
+#include "OrderAnalytics.h"
+#include "BestSellers.h"
+#include "Metrics.h"
+#include "Trace.h"
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <limits>
 #include <ctime>
 #include <sstream>
+#include <utility>
 
 using namespace std;
 
 // Function declarations
 void display();
 int getChoice();
-void addMenuItem(int &itemId, Menu &menu);
-void deleteMenuItem(Menu &menu);
-void resetMenu(Menu &menu);
-void addNewOrder(int &orderId ,OrderQueue &order, Menu &menu);
-void processNextOrder(OrderQueue &order, CompletedOrderStack &completedOrder);
+void addMenuItem(int &itemId, Menu &menu, OrderLog &log);
+void deleteMenuItem(Menu &menu, OrderLog &log);
+void resetMenu(Menu &menu, OrderLog &log);
+void addNewOrder(int &orderId ,OrderQueue &order, Menu &menu, OrderLog &log);
+void processOrders(OrderQueue &order, CompletedOrderStack &completedOrder,
+                   KitchenExecutor &kitchen);
 void displayOrder(OrderQueue &order, CompletedOrderStack &completedOrder);
-void deleteOrder(OrderQueue &order);
+void deleteOrder(OrderQueue &order, OrderLog &log);
 void calculateTotalRevenue(CompletedOrderStack &completedOrder);
-void saveCompletedOrdersToFile(CompletedOrderStack &completedOrder);
-void exit(Menu &menu);
-
-int main() {
+void bestSellers(const BestSellers &hour, const BestSellers &day,
+                 const BestSellers &allTime, Menu &menu);
+void saveCompletedOrdersToFile(CompletedOrderStack &completedOrder, OrderLog &log);
+void salesReport(CompletedOrderStack &completedOrder, Menu &menu);
+void latencyReport(KitchenExecutor &kitchen);
+void metricsReport();
+void exportTrace(const string &traceFile);
+void searchMenu(Menu &menu);
+void exit(Menu &menu, const string &menuFile, OrderLog &log);
+
+int main(int argc, char* argv[]) {
     
     Menu menu;                          // Manages the restaurant's menu
     OrderQueue order;                   // Handles pending orders
     CompletedOrderStack completedOrder; // Stores completed orders
+    OrderLog log;                       // Write-ahead log of every change
+
+    // Best sellers of this hour, of today and of all time
+    BestSellers hourSellers(64, BestSellers::HOUR);
+    BestSellers daySellers(64, BestSellers::DAY);
+    BestSellers allSellers(64);
+
+    // Worker threads that prepare orders; each completion is logged and counted
+    KitchenExecutor kitchen(0, [&](Order &o){
+        log.logOrderComplete(o.getOrderId());
+        time_t now = time(0);
+        hourSellers.record(o, now);
+        daySellers.record(o, now);
+        allSellers.record(o, now);
+    });
+
     int orderId = 1;                    // Unique identifier for orders
+    string menuFile = "menu.txt";       // Menu loaded at start, saved on exit
+    const char* batchFile = NULL;       // Script to run instead of the prompts
+    const char* logFile = NULL;         // Write-ahead log, see --log
+    const char* metricsFile = NULL;     // Periodic metrics dump, see --metrics
+    string traceFile = "trace.json";    // Timeline written by Export Trace
+
+    // Read the command-line options
+    for(int i = 1; i + 1 < argc; i += 2){
+        if(strcmp(argv[i], "--menu") == 0){
+            menuFile = argv[i + 1];
+        } else if(strcmp(argv[i], "--batch") == 0){
+            batchFile = argv[i + 1];
+        } else if(strcmp(argv[i], "--log") == 0){
+            logFile = argv[i + 1];
+        } else if(strcmp(argv[i], "--metrics") == 0){
+            metricsFile = argv[i + 1];
+        } else if(strcmp(argv[i], "--trace") == 0){
+            traceFile = argv[i + 1];
+            Trace::enable();
+        } else {
+            cerr << "Unknown option " << argv[i] << endl;
+            return 1;
+        }
+    }
 
-    menu.loadFromFile("menu.txt");          // Load menu data from file
+    Trace::setThreadName("main");
+    if(metricsFile)
+        Metrics::startDumping(metricsFile, Metrics::DUMP_INTERVAL);
+
+    // Load menu data from file; snapshots are mapped instead of parsed
+    if(Menu::isSnapshotFile(menuFile))
+        menu.loadSnapshot(menuFile);
+    else
+        menu.loadFromFile(menuFile);
+
+    // Replay what the last run logged but did not save
+    if(!batchFile && !logFile)
+        logFile = "orders.log";
+    if(logFile && log.open(logFile)){
+        int records = log.recover(menu, order, completedOrder, orderId);
+        if(records > 0)
+            cout << "Recovered " << records << " change(s) from " << logFile << endl;
+
+        // When they were completed is lost, so they only count overall
+        CompletedOrderStack::const_reverse_iterator it;
+        for(it = completedOrder.rbegin(); it != completedOrder.rend(); ++it)
+            allSellers.record(*it, time(0));
+    }
     int itemId = menu.getLastItemId() + 1;  // Initialize item ID counter for new items
+
+    // Headless mode: run a script and report, leaving the menu file untouched
+    if(batchFile){
+        BatchDriver driver(menu, order, completedOrder, kitchen, itemId, orderId,
+                           &log, &allSellers);
+        int failures;
+
+        if(strcmp(batchFile, "-") == 0){
+            failures = driver.run(cin);
+        } else {
+            ifstream script(batchFile);
+            if(!script){
+                cerr << "Error opening file for reading!" << endl;
+                return 1;
+            }
+            failures = driver.run(script);
+        }
+
+        driver.printReport(cout);
+        if(log.isOpen()){
+            log.flush();
+            log.printStats(cout);
+        }
+        Metrics::stopDumping(); // Writes the final values
+        if(Trace::isEnabled())
+            exportTrace(traceFile);
+        return failures == 0 ? 0 : 1;
+    }
     
     int choice;  // User menu choice
     do{
@@ -74,20 +203,30 @@ int main() {
         
         switch (choice) {
             case 1: cout << menu; break;
-            case 2: addMenuItem(itemId, menu); break;
-            case 3: deleteMenuItem(menu); break;
-            case 4: resetMenu(menu); break;
-            case 5: addNewOrder(orderId, order, menu); break;
-            case 6: processNextOrder(order, completedOrder); break;
+            case 2: addMenuItem(itemId, menu, log); break;
+            case 3: deleteMenuItem(menu, log); break;
+            case 4: resetMenu(menu, log); break;
+            case 5: addNewOrder(orderId, order, menu, log); break;
+            case 6: processOrders(order, completedOrder, kitchen); break;
             case 7: displayOrder(order, completedOrder); break;
-            case 8: deleteOrder(order); break;
+            case 8: deleteOrder(order, log); break;
             case 9: calculateTotalRevenue(completedOrder); break;
-            case 10: saveCompletedOrdersToFile(completedOrder); break;
-            case 11: exit(menu); break;
+            case 10: bestSellers(hourSellers, daySellers, allSellers, menu); break;
+            case 11: saveCompletedOrdersToFile(completedOrder, log); break;
+            case 12: salesReport(completedOrder, menu); break;
+            case 13: latencyReport(kitchen); break;
+            case 14: metricsReport(); break;
+            case 15: exportTrace(traceFile); break;
+            case 16: searchMenu(menu); break;
+            case 17: exit(menu, menuFile, log); break;
         }
         
         cout << endl;
-    } while(choice != 11); // Loop until the user exits
+    } while(choice != 17); // Loop until the user exits
+
+    Metrics::stopDumping();
+    if(Trace::isEnabled())
+        exportTrace(traceFile);
 
     return 0;
 }
@@ -97,7 +236,7 @@ int main() {
  * Purpose:
  *   Displays the main menu options for the system.
  * Functionality:
- *   - Prints menu options (1–11) for the restaurant order management system.
+ *   - Prints menu options (1–17) for the restaurant order management system.
  * Input: None
  * Output: Menu options displayed on the console.
  * Usage: Allows the user to choose system operations.
@@ -105,12 +244,12 @@ int main() {
 int getChoice() {
     int choice;
     while (true) {
-        cout << "Enter your choice (1-11): ";
+        cout << "Enter your choice (1-17): ";
         cin >> choice;
 
         // Check if input is valid and in the range
-        if (cin.fail() || choice < 1 || choice > 11) {
-            cout << "Invalid input. Please enter a number between 1 and 11." 
+        if (cin.fail() || choice < 1 || choice > 17) {
+            cout << "Invalid input. Please enter a number between 1 and 17." 
                 << endl;
 
             // Clear error flags and discard invalid input
@@ -129,7 +268,7 @@ int getChoice() {
  * Purpose:
  *   Displays the main menu options for the restaurant order management system.
  * Functionality:
- *   - Prints numbered menu options (1–11) 
+ *   - Prints numbered menu options (1–17) 
  *          that correspond to the program's main operations.
  * Input: None
  * Output: Displays menu options on the console.
@@ -142,16 +281,22 @@ void display(){
     cout << "3. Delete Menu Item" << endl;
     cout << "4. Reset Menu" << endl;
     cout << "5. Add New Order" << endl;
-    cout << "6. Process Next Order" << endl;
+    cout << "6. Process Orders" << endl;
     cout << "7. Display Orders" << endl;
     cout << "8. Delete Order" << endl;
     cout << "9. Calculate Total Amount of Sold Orders" << endl;
-    cout << "10. Save Completed Orders to File" << endl;
-    cout << "11. Exit" << endl;
+    cout << "10. Best Sellers" << endl;
+    cout << "11. Save Completed Orders to File" << endl;
+    cout << "12. Sales Report" << endl;
+    cout << "13. Order Latency Report" << endl;
+    cout << "14. Metrics Report" << endl;
+    cout << "15. Export Trace" << endl;
+    cout << "16. Search Menu" << endl;
+    cout << "17. Exit" << endl;
 }
 
 /**
- * addMenuItem(int &itemId, Menu &menu)
+ * addMenuItem(int &itemId, Menu &menu, OrderLog &log)
  * Purpose:
  *   Allows the user to add a new item to the restaurant menu.
  * Functionality:
@@ -163,13 +308,16 @@ void display(){
  * Input:
  *   - `itemId` (Reference): The current item ID to be assigned.
  *   - `menu` (Menu object): The menu to which the item will be added.
+ *   - `log` (OrderLog object): Records the new item.
  * Output: Confirmation of success or failure.
  * Usage: Adds a new menu item with details provided by the user.
  */
-void addMenuItem(int &itemId, Menu &menu){
+void addMenuItem(int &itemId, Menu &menu, OrderLog &log){
+    TRACE_SPAN("addMenuItem");
     string name;
     string description;
-    double price;
+    string priceText;
+    Money price;
 
     // Prompt for item's name
     cout << "Enter item name: ";
@@ -193,8 +341,8 @@ void addMenuItem(int &itemId, Menu &menu){
     // Prompt for item's price
     cout << "Enter item price: ";
     while (true) {
-        cin >> price;
-        if (price > 0) break;
+        cin >> priceText;
+        if (Money::parse(priceText, price) && price > Money()) break;
         cout << "Please enter a valid price greater than 0: ";
         cin.clear();  // Clear any error state
         cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Ignore invalid input
@@ -202,12 +350,13 @@ void addMenuItem(int &itemId, Menu &menu){
                 
     MenuItem item(itemId++, name, description, price);
     menu.addItem(item);
+    log.logMenuAdd(item);
 
     cout << "Item added successfully to the menu." << endl;    
 }
 
 /**
- * deleteMenuItem(Menu &menu)
+ * deleteMenuItem(Menu &menu, OrderLog &log)
  * Purpose:
  *   Deletes an item from the menu by its ID.
  * Functionality:
@@ -216,10 +365,12 @@ void addMenuItem(int &itemId, Menu &menu){
  *   - Deletes the item if found; otherwise, displays an error message.
  * Input: 
  *   - `menu` (Menu object): The menu from which the item will be deleted.
+ *   - `log` (OrderLog object): Records the deletion.
  * Output: Confirmation of success or failure.
  * Usage: Removes a specific item from the menu.
  */
-void deleteMenuItem(Menu &menu){
+void deleteMenuItem(Menu &menu, OrderLog &log){
+    TRACE_SPAN("deleteMenuItem");
     int id;
 
     // Prompt for item's ID to be deleted
@@ -235,6 +386,7 @@ void deleteMenuItem(Menu &menu){
     }
 
     if(menu.deleteItem(id)){
+        log.logMenuDelete(id);
         cout << "Item Deleted Successfully." << endl;
     } else {
         cout << "Item not found." << endl;
@@ -242,24 +394,27 @@ void deleteMenuItem(Menu &menu){
 }
 
 /**
- * resetMenu(Menu &menu)
+ * resetMenu(Menu &menu, OrderLog &log)
  * Purpose:
  *   Clears all items from the menu.
  * Functionality:
  *   - Invokes the `reset()` function on the `menu` object to delete all items.
  * Input:
  *   - `menu` (Menu object): The menu to be cleared.
+ *   - `log` (OrderLog object): Records the reset.
  * Output: Confirmation message.
  * Usage: Resets the menu to an empty state.
  */
-void resetMenu(Menu &menu){
+void resetMenu(Menu &menu, OrderLog &log){
+    TRACE_SPAN("resetMenu");
     menu.reset(); // Call the reset menu function
+    log.logMenuReset();
 
     cout << "Menu successfully reset." << endl;
 }
 
 /**
- * addNewOrder(int &orderId, OrderQueue &order, Menu &menu)
+ * addNewOrder(int &orderId, OrderQueue &order, Menu &menu, OrderLog &log)
  * Purpose:
  *   Adds a new order to the order queue.
  * Functionality:
@@ -270,10 +425,12 @@ void resetMenu(Menu &menu){
  *   - `orderId` (Reference): The current order ID to be assigned.
  *   - `order` (OrderQueue object): The queue to which the order will be added.
  *   - `menu` (Menu object): Used to validate item IDs.
+ *   - `log` (OrderLog object): Records the new order.
  * Output: Confirmation of success or failure.
  * Usage: Creates a new order with items and adds it to the queue.
  */
-void addNewOrder(int &orderId, OrderQueue &order, Menu &menu){
+void addNewOrder(int &orderId, OrderQueue &order, Menu &menu, OrderLog &log){
+    TRACE_SPAN("addNewOrder");
     string name;
     int id;
 
@@ -289,7 +446,8 @@ void addNewOrder(int &orderId, OrderQueue &order, Menu &menu){
     // Prompt for items to be ordered by their ID
     cout << "Enter item IDs (0 to finish): ";
 
-    Order o(orderId, name);
+    Order o(orderId, name, &menu);
+    o.stamp(Order::CREATED); // The order is being taken from now on
     while(true){
         cin >> id;
         if (cin.fail()) {
@@ -315,36 +473,45 @@ void addNewOrder(int &orderId, OrderQueue &order, Menu &menu){
     if (o.isEmpty()) {
         cout << "No valid items were added. Order not created." << endl;
     } else {
-        order.enqueue(o);
+        log.logOrderAdd(o);
+        order.enqueue(move(o)); // Hand the order to the queue without copying
         cout << "Order added successfully!" << endl;
         orderId++;
     }
 }
 
 /**
- * processNextOrder(OrderQueue &order, CompletedOrderStack &completedOrder)
+ * processOrders(OrderQueue &order, CompletedOrderStack &completedOrder,
+ *               KitchenExecutor &kitchen)
  * Purpose:
- *   Processes the next order in the queue and moves it to the completed orders stack.
+ *   Processes every pending order and moves it to the completed orders stack.
  * Functionality:
- *   - Removes the first order from the queue.
- *   - Pushes the processed order to the completed orders stack.
+ *   - Hands all orders in the queue to the kitchen worker threads.
+ *   - Each worker prepares its orders, marks them completed and pushes them
+ *     onto the completed orders stack.
+ *   - Waits for the last order and displays per-worker throughput.
+ *   - Orders stay pending, so they can be displayed and deleted, until
+ *     this option sends them to the kitchen.
  * Input:
- *   - `order` (OrderQueue object): The queue from which the next order is processed.
+ *   - `order` (OrderQueue object): The queue from which the orders are processed.
  *   - `completedOrder` (CompletedOrderStack object): The stack to store completed orders.
- * Output: Confirmation of success or error if no orders are available.
+ *   - `kitchen` (KitchenExecutor object): The worker threads doing the work.
+ * Output: Number of orders processed, or an error if no orders are available.
  * Usage: Handles the transition of orders from pending to completed.
  */
-void processNextOrder(OrderQueue &order, CompletedOrderStack &completedOrder){
+void processOrders(OrderQueue &order, CompletedOrderStack &completedOrder,
+                   KitchenExecutor &kitchen){
+    TRACE_SPAN("processOrders");
     if (order.isEmpty()) {
         cout << "No orders to process!" << endl;
     } else {
-        // Process the next order
-        Order nextOrder = order.dequeue();
-        cout << "Processing order for "<< nextOrder.getCustomerName() << "..." << endl;
+        cout << "Processing orders with " << kitchen.getWorkerCount() 
+             << " kitchen worker(s)..." << endl;
+
+        int processed = kitchen.drain(order, completedOrder);
 
-        // Move it to Completed Orders stack
-        completedOrder.push(nextOrder);
-        cout << "Order processed succesfully!" << endl;
+        cout << processed << " order(s) processed succesfully!" << endl;
+        kitchen.printStats(cout);
     }
 }
 
@@ -362,12 +529,13 @@ void processNextOrder(OrderQueue &order, CompletedOrderStack &completedOrder){
  * Usage: Provides a summary of all orders in the system.
  */
 void displayOrder(OrderQueue &order, CompletedOrderStack &completedOrder){
+    TRACE_SPAN("displayOrder");
     cout << order; // Display all active orders
     cout << completedOrder; // Display all completed orders
 }
 
 /**
- * deleteOrder(OrderQueue &order)
+ * deleteOrder(OrderQueue &order, OrderLog &log)
  * Purpose:
  *   Deletes a specific order from the order queue.
  * Functionality:
@@ -376,10 +544,12 @@ void displayOrder(OrderQueue &order, CompletedOrderStack &completedOrder){
  *   - Deletes the order if found; otherwise, displays an error message.
  * Input:
  *   - `order` (OrderQueue object): The queue from which the order will be deleted.
+ *   - `log` (OrderLog object): Records the deletion.
  * Output: Confirmation of success or failure.
  * Usage: Removes a specific order from the queue.
  */
-void deleteOrder(OrderQueue &order){
+void deleteOrder(OrderQueue &order, OrderLog &log){
+    TRACE_SPAN("deleteOrder");
     int id;
 
     // Prompt for order ID to be deleted
@@ -395,6 +565,7 @@ void deleteOrder(OrderQueue &order){
     }
 
     if(order.deleteOrder(id)){
+        log.logOrderDelete(id);
         cout << "Order deleted succesfully." << endl;
     } else {
         cout << "Order not found." << endl;
@@ -406,7 +577,8 @@ void deleteOrder(OrderQueue &order){
  * Purpose:
  *   Calculates and displays the total revenue from completed orders.
  * Functionality:
- *   - Iterates through the completed orders stack to calculate individual order totals.
+ *   - Iterates through the completed orders stack, oldest first, to calculate 
+ *     individual order totals.
  *   - Displays the total revenue of all completed orders.
  * Input:
  *   - `completedOrder` (CompletedOrderStack object): The stack of completed orders.
@@ -414,61 +586,247 @@ void deleteOrder(OrderQueue &order){
  * Usage: Provides a financial summary of completed orders.
  */
 void calculateTotalRevenue(CompletedOrderStack &completedOrder){
+    TRACE_SPAN("calculateTotalRevenue");
     cout << "--- Total Revenue ---" << endl;
 
-    int size = completedOrder.size();
-    for (int i = 0; i < size; i++) {
-        Order o = completedOrder.getOrder(size - i - 1);  // Get each completed order
-        double orderTotal = o.calculateTotalAmount();  // Calculate the total for the order
-        cout << "Order " << i + 1 << ": $" << orderTotal << endl;
+    // Walk the completed orders oldest first, without copying them
+    int i = 0;
+    CompletedOrderStack::const_reverse_iterator it;
+    for (it = completedOrder.rbegin(); it != completedOrder.rend(); ++it) {
+        Money orderTotal = it->calculateTotalAmount();  // Calculate the total for the order
+        cout << "Order " << ++i << ": $" << orderTotal << endl;
     }
 
     cout << "Total Sold: $" << completedOrder.calculateTotalRevenue() << endl;
 }
 
 /**
- * saveCompletedOrdersToFile(CompletedOrderStack &completedOrder)
+ * bestSellers(const BestSellers &hour, const BestSellers &day,
+ *             const BestSellers &allTime, Menu &menu)
+ * Purpose:
+ *   Displays the top 10 items right now.
+ * Functionality:
+ *   - Reads the top 10 of the hourly, daily and all-time trackers, which are
+ *     kept up to date as orders complete, without scanning any order.
+ *   - Displays the units sold of each item; counts may exceed the true
+ *     quantity by at most the error shown.
+ * Input:
+ *   - `hour`, `day`, `allTime` (BestSellers objects): The trackers.
+ *   - `menu` (Menu object): Names the items.
+ * Output: Three rankings of the best selling items.
+ * Usage: Shows what sells best at the moment.
+ */
+void bestSellers(const BestSellers &hour, const BestSellers &day,
+                 const BestSellers &allTime, Menu &menu){
+    TRACE_SPAN("bestSellers");
+    const int TOP = 10;
+    const BestSellers* trackers[] = { &hour, &day, &allTime };
+    const char* titles[] = { "This Hour", "Today", "All Time" };
+    time_t now = time(0);
+
+    for (int t = 0; t < 3; t++) {
+        cout << "--- Best Sellers: " << titles[t] << " ---" << endl;
+
+        vector<BestSellers::Entry> best = trackers[t]->top(TOP, now);
+        if (best.empty()) {
+            cout << "No items sold yet." << endl;
+            continue;
+        }
+
+        for (size_t i = 0; i < best.size(); i++) {
+            MenuItem item = menu.getItemById(best[i].itemId);
+            cout << (i + 1) << ". "
+                 << (item.getId() == -1 ? "(deleted item)" : item.getName())
+                 << " (ID " << best[i].itemId << "): " << best[i].quantity << " sold";
+            if (best[i].error > 0)
+                cout << " (up to " << best[i].error << " fewer)";
+            cout << endl;
+        }
+    }
+}
+
+/**
+ * saveCompletedOrdersToFile(CompletedOrderStack &completedOrder, OrderLog &log)
  * Purpose:
- *   Saves all completed orders to a file.
+ *   Saves the completed orders to a file.
  * Functionality:
- *   - Writes the details of completed orders to a specified file (`completed_orders.txt`).
+ *   - Appends the orders completed since the last save to today's file
+ *     (`completed_orders (Y-M-D).txt`), oldest first, and updates the revenue
+ *     line at its end. Orders saved earlier, even by a previous run, are kept.
+ *   - Logs which orders were saved, so a restart after a crash does not save
+ *     the recovered ones again.
  * Input:
  *   - `completedOrder` (CompletedOrderStack object): The stack of completed orders.
+ *   - `log` (OrderLog object): Records the save.
  * Output: Confirmation of success.
  * Usage: Ensures order data is persisted for future reference.
  */
-void saveCompletedOrdersToFile(CompletedOrderStack &completedOrder){
+void saveCompletedOrdersToFile(CompletedOrderStack &completedOrder, OrderLog &log){
+    TRACE_SPAN("saveCompletedOrdersToFile");
     cout << "Saving completed orders to file..." << endl;
 
-    // Get the current date
-    time_t now = time(0);
-    tm *time = localtime(&now);
+    // Save under a file name with the current date
+    vector<int> savedIds;
+    int saved = completedOrder.appendToFile(CompletedOrderStack::dailyFileName(time(0)),
+                                            &savedIds);
+    if(saved < 0)
+        return;
+    if(saved > 0){
+        log.logOrdersSaved(savedIds);
+        log.flush(); // The file already holds them
+    }
 
-    // Create the file name with the date
-    stringstream filename;
-    filename << "completed_orders (" 
-             << (1900 + time->tm_year) << "-" 
-             << (time->tm_mon + 1) << "-" 
-             << time->tm_mday << ").txt";
+    cout << saved << " new order(s) saved successfully!" << endl;
+}
 
-    completedOrder.saveToFile(filename.str());
+/**
+ * salesReport(CompletedOrderStack &completedOrder, Menu &menu)
+ * Purpose:
+ *   Displays what the completed orders sold.
+ * Functionality:
+ *   - Loads the completed orders into an OrderAnalytics column store.
+ *   - Displays the revenue, the average order value, the quantity and revenue
+ *     of each item, best selling first, and how many units the orders hold.
+ * Input:
+ *   - `completedOrder` (CompletedOrderStack object): The stack of completed orders.
+ *   - `menu` (Menu object): Names the items sold.
+ * Output: The sales report.
+ * Usage: Shows which items sell and how large orders are.
+ */
+void salesReport(CompletedOrderStack &completedOrder, Menu &menu){
+    TRACE_SPAN("salesReport");
+    OrderAnalytics analytics;
+    analytics.loadFrom(completedOrder);
+    analytics.printReport(cout, menu);
+}
+
+/**
+ * latencyReport(KitchenExecutor &kitchen)
+ * Purpose:
+ *   Displays how long orders take.
+ * Functionality:
+ *   - Displays the mean, p50, p90, p99, p99.9 and maximum of the time orders
+ *     waited in the queue before processing, spent in the kitchen, and took
+ *     from being created to being completed, in microseconds.
+ * Input:
+ *   - `kitchen` (KitchenExecutor object): Records the times as it completes orders.
+ * Output: The latency table.
+ * Usage: Shows whether orders are kept waiting.
+ */
+void latencyReport(KitchenExecutor &kitchen){
+    TRACE_SPAN("latencyReport");
+    cout << "--- Order Latency ---" << endl;
+    if (kitchen.getTimeToComplete().getCount() == 0) {
+        cout << "No orders completed yet." << endl;
+        return;
+    }
+    kitchen.printLatency(cout);
+}
 
-    cout << "Orders saved successfully!" << endl;
+/**
+ * metricsReport()
+ * Purpose:
+ *   Displays what the system has been doing.
+ * Functionality:
+ *   - Displays every counter (menu lookups and misses, array
+ *     reallocations, orders queued, dequeued and cancelled, allocation
+ *     failures) and gauge (orders waiting, orders completed) with its
+ *     current value.
+ * Input: None
+ * Output: The metrics table.
+ * Usage: The same values that `--metrics` writes to a file.
+ */
+void metricsReport(){
+    TRACE_SPAN("metricsReport");
+    cout << "--- Metrics ---" << endl;
+    Metrics::printReport(cout);
+}
+
+/**
+ * exportTrace(const string &traceFile)
+ * Purpose:
+ *   Records a timeline of the session for chrome://tracing or Perfetto.
+ * Functionality:
+ *   - The first time, starts tracing (unless `--trace` already did).
+ *   - Afterwards, writes the spans of every thread traced so far and the
+ *     timeline of every completed order to the trace file, as Chrome
+ *     trace-event JSON. Tracing goes on, so later exports cover more.
+ * Input:
+ *   - `traceFile` (String): The file to write, `trace.json` by default.
+ * Output: Whether tracing started, or how many events were written.
+ * Usage: Shows where the time of a slow shift goes.
+ */
+void exportTrace(const string &traceFile){
+    if(!Trace::isEnabled()){
+        Trace::enable();
+        cout << "Tracing started. Choose this option again to save the trace." << endl;
+        return;
+    }
+
+    long long events = Trace::exportToFile(traceFile);
+    if(events >= 0){
+        cout << events << " event(s) written to " << traceFile << endl;
+        long long overwritten = Trace::getOverwritten();
+        if(overwritten > 0)
+            cout << "(" << overwritten << " older event(s) were overwritten)" << endl;
+    }
+}
+
+/**
+ * searchMenu(Menu &menu)
+ * Purpose:
+ *   Finds menu items as a cashier would look them up.
+ * Functionality:
+ *   - Prompts for search text, such as "burger" or "jus".
+ *   - Displays up to 10 items with words starting with every word of the
+ *     text, ignoring case: matches in the name first, then matches in
+ *     the description.
+ * Input:
+ *   - `menu` (Menu object): The menu to search.
+ * Output: The items found, or a message if there are none.
+ * Usage: Finds an item's ID without paging through the whole menu.
+ */
+void searchMenu(Menu &menu){
+    TRACE_SPAN("searchMenu");
+    string query;
+
+    cout << "Enter search text: ";
+    cin.ignore();
+    getline(cin, query);
+
+    vector<MenuItem> found = menu.search(query);
+    if(found.empty()){
+        cout << "No menu items match \"" << query << "\"." << endl;
+        return;
+    }
+    for(size_t i = 0; i < found.size(); i++){
+        cout << found[i];
+    }
 }
 
 /**
- * exit(Menu &menu)
+ * exit(Menu &menu, const string &menuFile, OrderLog &log)
  * Purpose:
  *   Safely exits the program and saves the current menu to a file.
  * Functionality:
- *   - Writes the menu data to a specified file (`menu.txt`).
+ *   - Writes the menu data to the menu file (`menu.txt` by default),
+ *     as a binary snapshot if it was loaded from one.
+ *   - Empties the write-ahead log: the menu is saved and, as before, the
+ *     orders of the session end with it.
  *   - Displays a goodbye message and terminates the program.
  * Input:
  *   - `menu` (Menu object): The menu to be saved.
+ *   - `menuFile` (String): The file the menu was loaded from.
+ *   - `log` (OrderLog object): The log to checkpoint.
  * Output: Goodbye message.
  * Usage: Ensures the menu is saved before exiting the program.
  */
-void exit(Menu &menu){
+void exit(Menu &menu, const string &menuFile, OrderLog &log){
+    TRACE_SPAN("exit");
     cout << "Exiting the program... Goodbye!";
-    menu.saveToFile("menu.txt");
+    if(Menu::isSnapshotFile(menuFile))
+        menu.saveSnapshot(menuFile);
+    else
+        menu.saveToFile(menuFile);
+    log.checkpoint();
 }